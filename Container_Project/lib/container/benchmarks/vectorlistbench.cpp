@@ -0,0 +1,576 @@
+/*
+ * Google Benchmark suite comparing VectorList with the standard
+ * sequence containers, and with plf::colony when <plf_colony.h>
+ * is on the include path.
+ *
+ * Every benchmark reports time per element as items_per_second and
+ * the peak heap use of the run as peak_bytes. Cache misses come
+ * from the perf counters of Google Benchmark where the library was
+ * built with libpfm and the kernel allows it, e.g.
+ *
+ *   ./vectorlistbench --benchmark_perf_counters=CYCLES,CACHE-MISSES
+ *
+ * Payloads are int, NonTrivial, whose 16 ints live on the heap so
+ * each of its elements moves an allocation around, and Inline<Bytes>,
+ * which holds Bytes bytes in the element itself so every slot is
+ * that large and every move copies them all.
+ *
+ * HugePageList runs the segment scans over blocks carved from huge
+ * pages. Its blocks are mapped rather than taken from the heap, so
+ * they do not show in its peak_bytes.
+ *
+ * The checkpoint benchmarks write to and read from a memfd, so they
+ * measure the container and the syscalls rather than a disk
+ * */
+#include <benchmark/benchmark.h>
+
+#include <deque>
+#include <list>
+#include <malloc.h>
+#include <mutex>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../globals.hpp"
+#include "../helpers/hugepages.hpp"
+#include "../tests/test.hpp"
+#include "../vectorlist/vectorlist.hpp"
+
+#if __has_include( <plf_colony.h> )
+#include <plf_colony.h>
+#define HAVE_PLF_COLONY 1
+#endif
+
+/*
+ * Heap accounting for peak_bytes. Every allocation of the process
+ * goes through here and is counted by its usable size
+ * */
+namespace
+{
+std::atomic<int64_t> heap_bytes{ 0 };
+std::atomic<int64_t> heap_peak{ 0 };
+
+void countAllocation( void* p )
+{
+  int64_t bytes = heap_bytes.fetch_add( malloc_usable_size( p ), std::memory_order_relaxed ) + malloc_usable_size( p );
+  int64_t peak = heap_peak.load( std::memory_order_relaxed );
+
+  while( bytes > peak && !heap_peak.compare_exchange_weak( peak, bytes, std::memory_order_relaxed ) ) {
+  }
+}
+
+void countFree( void* p )
+{
+  if( p ) heap_bytes.fetch_sub( malloc_usable_size( p ), std::memory_order_relaxed );
+}
+}
+
+void* operator new( size_t size )
+{
+  void* p = std::malloc( size ? size : 1 );
+  if( !p ) throw std::bad_alloc();
+
+  countAllocation( p );
+  return p;
+}
+
+void* operator new( size_t size, std::align_val_t alignment )
+{
+  size_t align = static_cast<size_t>( alignment );
+  void* p = std::aligned_alloc( align, ( std::max<size_t>( size, 1 ) + align - 1 ) / align * align );
+  if( !p ) throw std::bad_alloc();
+
+  countAllocation( p );
+  return p;
+}
+
+void operator delete( void* p ) noexcept
+{
+  countFree( p );
+  std::free( p );
+}
+
+void operator delete( void* p, std::align_val_t ) noexcept
+{
+  countFree( p );
+  std::free( p );
+}
+
+void operator delete( void* p, size_t ) noexcept
+{
+  countFree( p );
+  std::free( p );
+}
+
+void operator delete( void* p, size_t, std::align_val_t ) noexcept
+{
+  countFree( p );
+  std::free( p );
+}
+
+/*
+ * Records the heap high-water mark from construction
+ * on and reports it relative to the heap use back then
+ * */
+class PeakMemory
+{
+  private:
+  int64_t baseline_;
+
+  public:
+  PeakMemory( void )
+      : baseline_( heap_bytes.load( std::memory_order_relaxed ) )
+  {
+    heap_peak.store( baseline_, std::memory_order_relaxed );
+  }
+
+  void report( benchmark::State& state ) const
+  {
+    state.counters["peak_bytes"] = static_cast<double>( heap_peak.load( std::memory_order_relaxed ) - baseline_ );
+  }
+};
+
+/*
+ * A payload of Bytes bytes kept inline. Copies are user-provided,
+ * so it is not trivially copyable and takes the same paths through
+ * the containers as NonTrivial, but without the allocation
+ * */
+template <size_t Bytes>
+class Inline
+{
+  static_assert( Bytes >= sizeof( int ) && Bytes % sizeof( int ) == 0 );
+
+  public:
+  int data_[Bytes / sizeof( int )];
+
+  Inline( void )
+      : data_()
+  {
+  }
+
+  Inline( const Inline& other )
+  {
+    std::copy( other.data_, other.data_ + Bytes / sizeof( int ), data_ );
+  }
+
+  Inline& operator=( const Inline& other )
+  {
+    std::copy( other.data_, other.data_ + Bytes / sizeof( int ), data_ );
+    return *this;
+  }
+};
+
+template <class T> T makeValue( size_t i )
+{
+  T value;
+  value.data_[0] = static_cast<int>( i );
+  return value;
+}
+
+template <> int makeValue<int>( size_t i )
+{
+  return static_cast<int>( i );
+}
+
+template <class T> int valueOf( const T& value )
+{
+  return value.data_[0];
+}
+
+int valueOf( const int& value )
+{
+  return value;
+}
+
+/*
+ * How each container inserts an element and replaces the one a Ref
+ * stands for. Without stable references, as for vector and deque,
+ * a Ref is a position and removal swaps the last element into it
+ * */
+template <class C> struct Ops
+{
+  typedef typename C::value_type T;
+  typedef size_t Ref;
+  static constexpr bool stable = false;
+
+  static Ref insert( C& c, T&& value )
+  {
+    c.push_back( std::move( value ) );
+    return c.size() - 1;
+  }
+
+  static void replace( C& c, Ref& ref, T&& value )
+  {
+    if( ref + 1 != c.size() ) c[ref] = std::move( c.back() );
+    c.pop_back();
+    c.push_back( std::move( value ) );
+  }
+};
+
+template <class T> struct Ops<std::list<T> >
+{
+  typedef typename std::list<T>::iterator Ref;
+  static constexpr bool stable = true;
+
+  static Ref insert( std::list<T>& c, T&& value ) { return c.insert( c.end(), std::move( value ) ); }
+  static void erase( std::list<T>& c, Ref& ref ) { c.erase( ref ); }
+
+  static void replace( std::list<T>& c, Ref& ref, T&& value )
+  {
+    c.erase( ref );
+    ref = insert( c, std::move( value ) );
+  }
+};
+
+template <class T, class... Policies> struct Ops<VectorList<T, Policies...> >
+{
+  typedef VectorList<T, Policies...> C;
+  typedef Handle Ref;
+  static constexpr bool stable = true;
+
+  static Ref insert( C& c, T&& value ) { return c.emplaceHandle( std::move( value ) ); }
+  static void erase( C& c, Ref& ref ) { c.remove( ref ); }
+
+  static void replace( C& c, Ref& ref, T&& value )
+  {
+    c.remove( ref );
+    ref = insert( c, std::move( value ) );
+  }
+};
+
+#ifdef HAVE_PLF_COLONY
+template <class T> struct Ops<plf::colony<T> >
+{
+  typedef typename plf::colony<T>::iterator Ref;
+  static constexpr bool stable = true;
+
+  static Ref insert( plf::colony<T>& c, T&& value ) { return c.insert( std::move( value ) ); }
+  static void erase( plf::colony<T>& c, Ref& ref ) { c.erase( ref ); }
+
+  static void replace( plf::colony<T>& c, Ref& ref, T&& value )
+  {
+    c.erase( ref );
+    ref = insert( c, std::move( value ) );
+  }
+};
+#endif
+
+/*
+ * Fill a container with n elements
+ * */
+template <class C>
+void BM_Emplace( benchmark::State& state )
+{
+  typedef typename C::value_type T;
+  size_t n = state.range( 0 );
+  PeakMemory memory;
+
+  for( auto _ : state ) {
+    C c;
+
+    for( size_t i = 0; i < n; ++i ) {
+      Ops<C>::insert( c, makeValue<T>( i ) );
+    }
+    benchmark::DoNotOptimize( c );
+  }
+
+  state.SetItemsProcessed( state.iterations() * n );
+  memory.report( state );
+}
+
+/*
+ * Remove a random element and insert a new one, keeping n elements.
+ * Each iteration does CHURN_BATCH replacements
+ * */
+#define CHURN_BATCH 1024
+
+template <class C>
+void BM_Churn( benchmark::State& state )
+{
+  typedef typename C::value_type T;
+  size_t n = state.range( 0 );
+
+  // the references are bookkeeping of the benchmark, not of c
+  std::vector<typename Ops<C>::Ref> refs;
+  refs.reserve( n );
+
+  PeakMemory memory;
+  C c;
+
+  for( size_t i = 0; i < n; ++i ) {
+    refs.push_back( Ops<C>::insert( c, makeValue<T>( i ) ) );
+  }
+
+  std::mt19937 gen{ 42 };
+  std::uniform_int_distribution<size_t> range{ 0, n - 1 };
+  std::vector<size_t> victims( CHURN_BATCH );
+
+  for( auto& victim : victims ) {
+    victim = range( gen );
+  }
+
+  size_t value = n;
+
+  for( auto _ : state ) {
+    for( size_t victim : victims ) {
+      Ops<C>::replace( c, refs[victim], makeValue<T>( value++ ) );
+    }
+  }
+
+  state.SetItemsProcessed( state.iterations() * CHURN_BATCH );
+  memory.report( state );
+}
+
+/*
+ * Build a container of n elements of which state.range( 1 ) percent
+ * are left. Containers with stable references have the rest removed
+ * at random, leaving holes, the others are simply filled less.
+ * refs should have room for n references up front so that it does
+ * not count towards peak_bytes
+ * */
+template <class C>
+void fillToOccupancy( C& c, std::vector<typename Ops<C>::Ref>& refs, size_t n, size_t occupancy )
+{
+  typedef typename C::value_type T;
+
+  if constexpr( Ops<C>::stable ) {
+    for( size_t i = 0; i < n; ++i ) {
+      refs.push_back( Ops<C>::insert( c, makeValue<T>( i ) ) );
+    }
+
+    std::mt19937 gen{ 42 };
+    std::shuffle( refs.begin(), refs.end(), gen );
+
+    for( size_t i = 0; i < n - n * occupancy / 100; ++i ) {
+      Ops<C>::erase( c, refs[i] );
+    }
+  } else {
+    for( size_t i = 0; i < n * occupancy / 100; ++i ) {
+      Ops<C>::insert( c, makeValue<T>( i ) );
+    }
+  }
+}
+
+/*
+ * Visit every element once
+ * */
+template <class C>
+void BM_Iterate( benchmark::State& state )
+{
+  size_t n = state.range( 0 );
+
+  std::vector<typename Ops<C>::Ref> refs;
+  refs.reserve( n );
+
+  PeakMemory memory;
+  C c;
+  fillToOccupancy( c, refs, n, state.range( 1 ) );
+
+  for( auto _ : state ) {
+    int64_t sum = 0;
+
+    for( auto& value : c ) {
+      sum += valueOf( value );
+    }
+    benchmark::DoNotOptimize( sum );
+  }
+
+  state.SetItemsProcessed( state.iterations() * n * state.range( 1 ) / 100 );
+  memory.report( state );
+}
+
+/*
+ * A VectorList whose blocks fill whole huge pages, all taken
+ * from one resource shared by every benchmark
+ * */
+Utils::HugePageResource huge_pages;
+
+template <class T>
+using HugePageList = pmr::VectorList<T, Utils::BackoffPolicy, Utils::HugePageGrowth<> >;
+
+template <class C>
+typename C::allocator_type benchAllocator( void )
+{
+  typedef typename C::allocator_type Allocator;
+
+  if constexpr( std::is_same_v<Allocator, std::pmr::polymorphic_allocator<typename C::value_type> > ) {
+    return Allocator( &huge_pages );
+  } else {
+    return Allocator();
+  }
+}
+
+/*
+ * Visit every element of a VectorList through its segments
+ * */
+template <class C>
+void BM_IterateSegments( benchmark::State& state )
+{
+  typedef typename C::value_type T;
+  size_t n = state.range( 0 );
+
+  std::vector<Handle> refs;
+  refs.reserve( n );
+
+  PeakMemory memory;
+  C c( benchAllocator<C>() );
+  fillToOccupancy( c, refs, n, state.range( 1 ) );
+
+  for( auto _ : state ) {
+    int64_t sum = 0;
+
+    for( auto segment : c.segments() ) {
+      segment.forEach( [&]( const T& value ) -> void { sum += valueOf( value ); } );
+    }
+    benchmark::DoNotOptimize( sum );
+  }
+
+  state.SetItemsProcessed( state.iterations() * n * state.range( 1 ) / 100 );
+  memory.report( state );
+}
+
+/*
+ * Insert n elements from state.range( 1 ) threads at once. VectorList
+ * is shared as is, the other containers behind a std::mutex
+ * */
+template <class C>
+void BM_ThreadedInsert( benchmark::State& state )
+{
+  typedef typename C::value_type T;
+  size_t n = state.range( 0 );
+  size_t num_threads = state.range( 1 );
+  PeakMemory memory;
+
+  for( auto _ : state ) {
+    C c;
+    std::mutex mutex;
+    std::vector<std::thread> threads;
+
+    for( size_t t = 0; t < num_threads; ++t ) {
+      threads.emplace_back( [&, t]( void ) -> void {
+        for( size_t i = t; i < n; i += num_threads ) {
+          if constexpr( std::is_same_v<C, VectorList<T> > ) {
+            c.emplace( makeValue<T>( i ) );
+          } else {
+            std::lock_guard<std::mutex> guard( mutex );
+            Ops<C>::insert( c, makeValue<T>( i ) );
+          }
+        }
+      } );
+    }
+
+    for( auto& thread : threads ) {
+      thread.join();
+    }
+    benchmark::DoNotOptimize( c );
+  }
+
+  state.SetItemsProcessed( state.iterations() * n );
+  memory.report( state );
+}
+
+/*
+ * Write a VectorList of n ints at state.range( 1 ) percent
+ * occupancy, element by element through a stdio buffer when
+ * state.range( 2 ) is 0, else with snapshot()
+ * */
+void BM_Checkpoint( benchmark::State& state )
+{
+  size_t n = state.range( 0 );
+
+  std::vector<Handle> refs;
+  refs.reserve( n );
+
+  VectorList<int> c;
+  fillToOccupancy( c, refs, n, state.range( 1 ) );
+
+  int fd = memfd_create( "checkpoint", 0 );
+  FILE* file = fdopen( fd, "w" );
+  size_t bytes = 0;
+
+  for( auto _ : state ) {
+    lseek( fd, 0, SEEK_SET );
+
+    if( state.range( 2 ) ) {
+      c.snapshot( fd );
+    } else {
+      for( int& value : c ) {
+        std::fwrite( &value, sizeof( value ), 1, file );
+      }
+      std::fflush( file );
+    }
+
+    bytes += lseek( fd, 0, SEEK_CUR );
+  }
+
+  std::fclose( file );
+  state.SetItemsProcessed( state.iterations() * n * state.range( 1 ) / 100 );
+  state.SetBytesProcessed( bytes );
+}
+
+/*
+ * Read back a snapshot of a VectorList of n ints at
+ * state.range( 1 ) percent occupancy with restore()
+ * */
+void BM_Restore( benchmark::State& state )
+{
+  size_t n = state.range( 0 );
+
+  std::vector<Handle> refs;
+  refs.reserve( n );
+
+  VectorList<int> c;
+  fillToOccupancy( c, refs, n, state.range( 1 ) );
+
+  int fd = memfd_create( "restore", 0 );
+  c.snapshot( fd );
+  size_t bytes = lseek( fd, 0, SEEK_CUR );
+
+  VectorList<int> restored;
+
+  for( auto _ : state ) {
+    lseek( fd, 0, SEEK_SET );
+    restored.restore( fd );
+  }
+
+  close( fd );
+  state.SetItemsProcessed( state.iterations() * n * state.range( 1 ) / 100 );
+  state.SetBytesProcessed( state.iterations() * bytes );
+}
+
+#define CONTAINER_BENCHMARKS( C )                                                                                   \
+  BENCHMARK_TEMPLATE( BM_Emplace, C )->Arg( 1 << 10 )->Arg( 1 << 16 );                                             \
+  BENCHMARK_TEMPLATE( BM_Churn, C )->Arg( 1 << 10 )->Arg( 1 << 16 );                                               \
+  BENCHMARK_TEMPLATE( BM_Iterate, C )->ArgsProduct( { { 1 << 16 }, { 10, 50, 90, 100 } } );                         \
+  BENCHMARK_TEMPLATE( BM_ThreadedInsert, C )->ArgsProduct( { { 1 << 16 }, { 1, 2, 4 } } )->UseRealTime();
+
+CONTAINER_BENCHMARKS( VectorList<int> )
+CONTAINER_BENCHMARKS( VectorList<NonTrivial> )
+CONTAINER_BENCHMARKS( VectorList<Inline<64> > )
+CONTAINER_BENCHMARKS( std::vector<int> )
+CONTAINER_BENCHMARKS( std::vector<NonTrivial> )
+CONTAINER_BENCHMARKS( std::vector<Inline<64> > )
+CONTAINER_BENCHMARKS( std::list<int> )
+CONTAINER_BENCHMARKS( std::list<NonTrivial> )
+CONTAINER_BENCHMARKS( std::list<Inline<64> > )
+CONTAINER_BENCHMARKS( std::deque<int> )
+CONTAINER_BENCHMARKS( std::deque<NonTrivial> )
+CONTAINER_BENCHMARKS( std::deque<Inline<64> > )
+
+#ifdef HAVE_PLF_COLONY
+CONTAINER_BENCHMARKS( plf::colony<int> )
+CONTAINER_BENCHMARKS( plf::colony<NonTrivial> )
+CONTAINER_BENCHMARKS( plf::colony<Inline<64> > )
+#endif
+
+BENCHMARK_TEMPLATE( BM_IterateSegments, VectorList<int> )->ArgsProduct( { { 1 << 16, 1 << 24 }, { 10, 50, 90, 100 } } );
+BENCHMARK_TEMPLATE( BM_IterateSegments, VectorList<NonTrivial> )->ArgsProduct( { { 1 << 16 }, { 10, 50, 90, 100 } } );
+BENCHMARK_TEMPLATE( BM_IterateSegments, VectorList<Inline<64> > )->ArgsProduct( { { 1 << 16 }, { 10, 50, 90, 100 } } );
+BENCHMARK_TEMPLATE( BM_IterateSegments, VectorList<Inline<256> > )->ArgsProduct( { { 1 << 16 }, { 10, 50, 90, 100 } } );
+BENCHMARK_TEMPLATE( BM_IterateSegments, HugePageList<int> )->ArgsProduct( { { 1 << 16, 1 << 24 }, { 10, 50, 90, 100 } } );
+
+BENCHMARK( BM_Checkpoint )->ArgsProduct( { { 1 << 16, 1 << 22 }, { 50, 100 }, { 0, 1 } } );
+BENCHMARK( BM_Restore )->ArgsProduct( { { 1 << 16, 1 << 22 }, { 50, 100 } } );
+
+BENCHMARK_MAIN();
@@ -18,6 +18,16 @@ constexpr size_t getSize()
   return sizeof( T ) < sizeof( T* ) ? sizeof( T* ) : sizeof( T );
 }
 
+/*
+ * Same as above but for alignment. The storage must be able
+ * to hold a pointer as well as a T
+ * */
+template <class T>
+constexpr size_t getAlignment()
+{
+  return std::max( alignof( T ), alignof( T* ) );
+}
+
 /*
  * Our Element class which contains either a type T
  * or a pointer to another Element
@@ -26,10 +36,14 @@ template <class T>
 class Element
 {
   private:
-  typename std::aligned_storage<getSize<T>(), alignof( T )>::type data_[1];
-  ElementState state_;
+  typename std::aligned_storage<getSize<T>(), getAlignment<T>()>::type data_[1];
+  std::atomic<ElementState> state_;
   std::atomic_flag lock_;
 
+  void copyFrom( const Element& other );
+  void moveFrom( Element& other );
+  void destroy( void );
+
   public:
   Element( void );
   Element( const Element& other );
@@ -38,13 +52,6 @@ class Element
   Element& operator=( Element&& other );
   ~Element( void );
 
-  void testFunction( const Element& other )
-  {
-    const T& other_data = *reinterpret_cast<const T*>( other.data_ );
-    new ( data_ ) T{ other_data };
-    state_ = ElementState::Alive;
-  }
-
   template <class... Args>
   void emplace( Args&&... args );
   void setNext( Element* next );
@@ -52,6 +59,7 @@ class Element
   void clear( void );
 
   T getData( void ) const;
+  T& getDataByReference( void );
   Element* getNext( void );
   ElementState getState( void ) const;
 };
@@ -63,7 +71,62 @@ template <class T>
 Element<T>::Element( void )
     : lock_( ATOMIC_FLAG_INIT )
 {
-  state_ = ElementState::Free;
+  state_.store( ElementState::Free, std::memory_order_relaxed );
+}
+
+/*
+ * Copy the state and the storage of another Element.
+ * Trivially copyable values are copied with the rest of the
+ * storage, others are copy-constructed while Free and Boundary
+ * links are copied as they are
+ * */
+template <class T>
+void Element<T>::copyFrom( const Element& other )
+{
+  ElementState state = other.getState();
+
+  if constexpr( std::is_trivially_copyable_v<T> ) {
+    std::memcpy( static_cast<void*>( data_ ), other.data_, sizeof( data_ ) );
+  } else if( state == ElementState::Alive ) {
+    new ( data_ ) T{ *reinterpret_cast<const T*>( other.data_ ) };
+  } else {
+    std::memcpy( static_cast<void*>( data_ ), other.data_, sizeof( data_ ) );
+  }
+
+  state_.store( state, std::memory_order_relaxed );
+}
+
+/*
+ * Same as copyFrom() but moves the value out of other,
+ * which is left Free
+ * */
+template <class T>
+void Element<T>::moveFrom( Element& other )
+{
+  ElementState state = other.getState();
+
+  if constexpr( std::is_trivially_copyable_v<T> ) {
+    std::memcpy( static_cast<void*>( data_ ), other.data_, sizeof( data_ ) );
+  } else if( state == ElementState::Alive ) {
+    new ( data_ ) T{ std::move( *reinterpret_cast<T*>( other.data_ ) ) };
+  } else {
+    std::memcpy( static_cast<void*>( data_ ), other.data_, sizeof( data_ ) );
+  }
+
+  state_.store( state, std::memory_order_relaxed );
+  if( state == ElementState::Alive ) other.clear();
+}
+
+/*
+ * Run the destructor of the value, which is a
+ * no-op for trivially destructible T
+ * */
+template <class T>
+void Element<T>::destroy( void )
+{
+  if constexpr( !std::is_trivially_destructible_v<T> ) {
+    reinterpret_cast<T*>( data_ )->~T();
+  }
 }
 
 /*
@@ -71,12 +134,9 @@ Element<T>::Element( void )
  * */
 template <class T>
 Element<T>::Element( const Element& other )
+    : lock_( ATOMIC_FLAG_INIT )
 {
-  auto mf = std::bind( &Element::testFunction, this, other );
-  Utils::spinLockExecutor<decltype( mf )>( mf, lock_ );
-  //  const T& other_data = *reinterpret_cast<const T*>( other.data_ );
-  //  new ( data_ ) T{ other_data };
-  //  state_ = ElementState::Alive;
+  copyFrom( other );
 }
 
 /*
@@ -84,12 +144,9 @@ Element<T>::Element( const Element& other )
  * */
 template <class T>
 Element<T>::Element( Element&& other )
+    : lock_( ATOMIC_FLAG_INIT )
 {
-  T&& other_data = std::move( *reinterpret_cast<T*>( other.data_ ) );
-  new ( data_ ) T{ std::forward<T>( other_data ) };
-  state_ = ElementState::Alive;
-
-  other.state_ = ElementState::Free;
+  moveFrom( other );
 }
 
 /*
@@ -98,8 +155,18 @@ Element<T>::Element( Element&& other )
 template <class T>
 Element<T>& Element<T>::operator=( const Element& other )
 {
-  *reinterpret_cast<T*>( data_ ) = *reinterpret_cast<T*>( other.data_ );
-  state_ = ElementState::Alive;
+  if( this == &other ) return *this;
+
+  if constexpr( !std::is_trivially_copyable_v<T> ) {
+    if( getState() == ElementState::Alive && other.getState() == ElementState::Alive ) {
+      *reinterpret_cast<T*>( data_ ) = *reinterpret_cast<const T*>( other.data_ );
+      return *this;
+    }
+  }
+
+  if( getState() == ElementState::Alive ) clear();
+  copyFrom( other );
+  return *this;
 }
 
 /*
@@ -108,9 +175,19 @@ Element<T>& Element<T>::operator=( const Element& other )
 template <class T>
 Element<T>& Element<T>::operator=( Element&& other )
 {
-  T&& other_data = std::move( *reinterpret_cast<T*>( other.data_ ) );
-  *reinterpret_cast<T*>( data_ ) = std::forward<T>( other_data );
-  state_ = ElementState::Alive;
+  if( this == &other ) return *this;
+
+  if constexpr( !std::is_trivially_copyable_v<T> ) {
+    if( getState() == ElementState::Alive && other.getState() == ElementState::Alive ) {
+      *reinterpret_cast<T*>( data_ ) = std::move( *reinterpret_cast<T*>( other.data_ ) );
+      other.clear();
+      return *this;
+    }
+  }
+
+  if( getState() == ElementState::Alive ) clear();
+  moveFrom( other );
+  return *this;
 }
 
 /*
@@ -119,11 +196,15 @@ Element<T>& Element<T>::operator=( Element&& other )
 template <class T>
 Element<T>::~Element( void )
 {
-  if( state_ == ElementState::Alive ) reinterpret_cast<const T*>( data_ )->~T();
+  if constexpr( !std::is_trivially_destructible_v<T> ) {
+    if( getState() == ElementState::Alive ) destroy();
+  }
 }
 
 /*
- * Construct an element in-place
+ * Construct an element in-place.
+ * The state is released after the value is constructed so a
+ * thread that observes Alive through getState() may read the value
  * */
 template <class T>
 template <class... Args>
@@ -131,7 +212,7 @@ void Element<T>::emplace( Args&&... args )
 {
   assert( state_ == ElementState::Free );
   new ( data_ ) T{ std::forward<Args>( args )... };
-  state_ = ElementState::Alive;
+  state_.store( ElementState::Alive, std::memory_order_release );
 }
 
 /*
@@ -152,7 +233,7 @@ void Element<T>::setNext( Element* next )
 template <class T>
 void Element<T>::makeBoundary( void )
 {
-  state_ = ElementState::Boundary;
+  state_.store( ElementState::Boundary, std::memory_order_relaxed );
 }
 
 /*
@@ -165,6 +246,16 @@ T Element<T>::getData( void ) const
   return *reinterpret_cast<const T*>( data_ );
 }
 
+/*
+ * Obtain a reference to the value T stored in the Element
+ * */
+template <class T>
+T& Element<T>::getDataByReference( void )
+{
+  assert( state_ == ElementState::Alive );
+  return *reinterpret_cast<T*>( data_ );
+}
+
 /*
  * Obtain the value of the "next" pointer stored in the Element
  * */
@@ -182,7 +273,7 @@ Element<T>* Element<T>::getNext( void )
 template <class T>
 ElementState Element<T>::getState( void ) const
 {
-  return state_;
+  return state_.load( std::memory_order_acquire );
 }
 
 /*
@@ -192,8 +283,8 @@ template <class T>
 void Element<T>::clear( void )
 {
   assert( state_ == ElementState::Alive );
-  reinterpret_cast<const T*>( data_ )->~T();
-  state_ = ElementState::Free;
+  destroy();
+  state_.store( ElementState::Free, std::memory_order_relaxed );
 }
 
 #endif // ELEMENT_HPP_
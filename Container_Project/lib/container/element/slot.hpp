@@ -0,0 +1,124 @@
+#ifndef SLOT_HPP_
+#define SLOT_HPP_
+
+#include "../globals.hpp"
+#include "./element.hpp"
+
+/*
+ * Payload storage for the structure-of-arrays block layout.
+ *
+ * Unlike an Element, a Slot does not record what it holds. The
+ * block keeps that in a separate dense array (its occupancy bitmap)
+ * so scans never pull payload cache lines just to read a state, and
+ * a Slot<T> is only as large as the bigger of T and a pointer
+ * instead of also carrying a state and a lock next to the value.
+ *
+ * A Slot holds one of
+ *  - a T while it is Alive
+ *  - the SlotId of the next free slot while it is Free
+ *  - a pointer to the neighbouring block while it is a Boundary
+ * */
+template <class T>
+class Slot
+{
+  private:
+  typename std::aligned_storage<getSize<T>(), getAlignment<T>()>::type data_[1];
+
+  public:
+  template <class... Args>
+  void emplace( Args&&... args );
+  void destroy( void );
+
+  T& get( void );
+  const T& get( void ) const;
+
+  void setNextSlot( SlotId next );
+  SlotId getNextSlot( void ) const;
+
+  void setNext( Slot* next );
+  Slot* loadNext( void );
+  bool publishNext( Slot* expected, Slot* next );
+};
+
+/*
+ * Construct a T in the storage of a Free Slot
+ * */
+template <class T>
+template <class... Args>
+void Slot<T>::emplace( Args&&... args )
+{
+  new ( data_ ) T{ std::forward<Args>( args )... };
+}
+
+/*
+ * Destroy the T held by an Alive Slot,
+ * a no-op for trivially destructible T
+ * */
+template <class T>
+void Slot<T>::destroy( void )
+{
+  if constexpr( !std::is_trivially_destructible_v<T> ) {
+    reinterpret_cast<T*>( data_ )->~T();
+  }
+}
+
+template <class T>
+T& Slot<T>::get( void )
+{
+  return *reinterpret_cast<T*>( data_ );
+}
+
+template <class T>
+const T& Slot<T>::get( void ) const
+{
+  return *reinterpret_cast<const T*>( data_ );
+}
+
+/*
+ * Assign the SlotId of the next free slot to a Free Slot
+ * */
+template <class T>
+void Slot<T>::setNextSlot( SlotId next )
+{
+  new ( data_ ) SlotId( next );
+}
+
+template <class T>
+SlotId Slot<T>::getNextSlot( void ) const
+{
+  return *reinterpret_cast<const SlotId*>( data_ );
+}
+
+/*
+ * Assign the neighbouring block's Boundary to a Boundary Slot.
+ * Only used while the block is still private
+ * */
+template <class T>
+void Slot<T>::setNext( Slot* next )
+{
+  new ( data_ ) Slot*( next );
+}
+
+/*
+ * Read the link of a Boundary that may be
+ * concurrently published to by another thread
+ * */
+template <class T>
+Slot<T>* Slot<T>::loadNext( void )
+{
+  return std::atomic_ref<Slot*>( *reinterpret_cast<Slot**>( data_ ) ).load( std::memory_order_acquire );
+}
+
+/*
+ * Atomically replace the link of a Boundary if it still holds
+ * expected. Everything written before the call is visible to
+ * threads that observe the new value through loadNext()
+ * */
+template <class T>
+bool Slot<T>::publishNext( Slot* expected, Slot* next )
+{
+  std::atomic_ref<Slot*> link( *reinterpret_cast<Slot**>( data_ ) );
+  return link.compare_exchange_strong( expected, next, std::memory_order_release, std::memory_order_relaxed );
+}
+
+#endif // SLOT_HPP_
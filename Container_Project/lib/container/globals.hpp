@@ -3,6 +3,35 @@
 
 #define INITIAL_BLOCK_SIZE 16
 #define BLOCK_INCREMENT 16
+#define MIN_BLOCK_SIZE 4
+#define MAX_BLOCK_SIZE ( size_t( 1 ) << 20 )
+#define GROWTH_CAP 8192
+#define BLOCK_PAGE_SIZE 4096
+#define HUGE_PAGE_SIZE ( size_t( 2 ) << 20 )
+#define HUGE_REGION_SIZE ( size_t( 64 ) << 20 )
+#define MAPPED_FILE_RESERVE ( size_t( 1 ) << 36 )
+#define MAPPED_FILE_GROWTH ( size_t( 16 ) << 20 )
+#define SNAPSHOT_MAGIC 0x564c495354534e03
+#define TRIM_RESERVE_BLOCKS 2
+#define PARALLEL_CHUNK_WORDS 64
+#define MAX_NUMA_NODES 8
+#define ALL_NODES SIZE_MAX
+
+#define CACHE_LINE_SIZE 64
+#define MAX_THREAD_CACHES 64
+#define THREAD_CACHE_SIZE 64
+#define THREAD_CACHE_BATCH 32
+#define MAX_BLOCK_SEGMENTS 48
+#define YIELD_SPIN_LIMIT 64
+#define MAX_BACKOFF_PAUSES 1024
+
+#define BITMAP_WORD_BITS 64
+#define NULL_SLOT UINT64_MAX
+#define NULL_BLOCK SIZE_MAX
+#define HANDLE_INDEX_BITS 20
+#define HANDLE_BLOCK_BITS 20
+#define HANDLE_GENERATION_BITS 24
+#define NULL_HANDLE UINT64_MAX
 
 #include <vector>
 #include <utility>
@@ -17,23 +46,163 @@
 #include <iomanip>
 #include <type_traits>
 #include <random>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 
 template <class T>
 class Element;
 
+template <class T>
+class Slot;
+
 template <class T>
 using BlockPtr = std::unique_ptr<Element<T> []>;
 
 typedef std::unique_ptr<std::atomic_flag[]> LockPtr;
 
+/*
+ * One bit per inner Element of a Block, set while it is Alive,
+ * followed by a summary with one bit per occupancy word, set
+ * while that word may be non-zero. Bitmaps of SlotBlocks end
+ * with one more word counting the Alive Elements of the block
+ * */
+typedef std::unique_ptr<std::atomic<uint64_t>[]> BitmapPtr;
+
 template <class T>
-using Block = std::tuple<BlockPtr<T>, LockPtr, size_t>;
+using Block = std::tuple<BlockPtr<T>, LockPtr, BitmapPtr, size_t>;
 
 template <class T>
 using Blocks = std::vector<Block<T> >;
 
+/*
+ * Owning pointer to an array obtained from an allocator. The
+ * deleter keeps a copy of the allocator, rebound to U, and the
+ * length of the array so the memory goes back where it came from
+ * */
+template <class U, class Allocator>
+struct ArrayDeleter
+{
+  typedef typename std::allocator_traits<Allocator>::template rebind_alloc<U> allocator_type;
+  typedef std::allocator_traits<allocator_type> traits;
+
+  allocator_type allocator;
+  size_t size;
+
+  void operator()( U* array )
+  {
+    for( size_t i = 0; i < size; ++i ) {
+      traits::destroy( allocator, array + i );
+    }
+    traits::deallocate( allocator, array, size );
+  }
+};
+
+template <class U, class Allocator>
+using ArrayPtr = std::unique_ptr<U[], ArrayDeleter<U, Allocator> >;
+
+/*
+ * Structure-of-arrays block: the payloads are packed in an array
+ * of Slots while which of them are Alive is kept in the bitmap.
+ * As with Block, index 0 and size + 1 of the Slots are Boundaries.
+ * The generation array counts how often each Slot was filled.
+ * All four arrays come from Allocator
+ * */
+template <class T, class Allocator = std::allocator<T> >
+using SlotPtr = ArrayPtr<Slot<T>, Allocator>;
+
+template <class Allocator>
+using LockArray = ArrayPtr<std::atomic_flag, Allocator>;
+
+template <class Allocator>
+using BitmapArray = ArrayPtr<std::atomic<uint64_t>, Allocator>;
+
+template <class Allocator>
+using GenerationArray = ArrayPtr<std::atomic<uint32_t>, Allocator>;
+
+template <class T, class Allocator = std::allocator<T> >
+using SlotBlock =
+  std::tuple<SlotPtr<T, Allocator>, LockArray<Allocator>, BitmapArray<Allocator>, GenerationArray<Allocator>, size_t>;
+
+template <class T, class Allocator = std::allocator<T> >
+using SlotBlocks = std::vector<SlotBlock<T, Allocator>,
+                               typename std::allocator_traits<Allocator>::template rebind_alloc<SlotBlock<T, Allocator> > >;
+
+/*
+ * Non-owning view of a SlotBlock used by readers
+ * that cannot take the container lock.
+ * A retired block is left as an entry with no slots.
+ * offset is the number of slots in the blocks before this one
+ * in iteration order, node the NUMA node the block is for.
+ * id names the block in SlotIds and Handles, position is its
+ * place in iteration order
+ * */
 template <class T>
-using FreeLists = std::unordered_map<std::thread::id, Element<T>*>;
+struct BlockInfo
+{
+  Slot<T>* slots;
+  std::atomic_flag* locks;
+  std::atomic<uint64_t>* occupancy;
+  std::atomic<uint64_t>* summary;
+  std::atomic<uint64_t>* live;
+  std::atomic<uint32_t>* generations;
+  size_t size;
+  size_t offset;
+  size_t node;
+  size_t id;
+  size_t position;
+};
+
+/*
+ * Free lists link slots by SlotId rather than by pointer so the
+ * block a slot belongs to is known without a search.
+ * The high half is the block id, the low half the index of
+ * the slot within the block (1 for the first inner slot)
+ * */
+typedef uint64_t SlotId;
+
+/*
+ * Stable reference to an element that can tell when the element
+ * it was made for has been removed. From the high bits down it
+ * holds the generation of the slot, the block id and the bit
+ * of the slot in the occupancy bitmap of its block
+ * */
+typedef uint64_t Handle;
+
+/*
+ * A list of free slots owned by a single thread.
+ * live is the number of elements inserted minus the number
+ * removed through this cache and is only written by its owner.
+ * node is the NUMA node the blocks of its free slots are for
+ * */
+struct alignas( CACHE_LINE_SIZE ) FreeCache
+{
+  SlotId head = NULL_SLOT;
+  size_t count = 0;
+  size_t node = 0;
+  std::atomic<std::ptrdiff_t> live{ 0 };
+};
+
+typedef std::unique_ptr<FreeCache[]> FreeCaches;
+
+/*
+ * The Free slots of one node that no thread cache holds. They are
+ * kept by the blocks of the node themselves, and first is the id of
+ * the first of those blocks holding any, the others following it.
+ * count is the number of Free slots they hold together, live is as
+ * for FreeCache
+ * */
+struct alignas( CACHE_LINE_SIZE ) FreePool
+{
+  size_t first = NULL_BLOCK;
+  size_t count = 0;
+  size_t node = 0;
+  std::atomic<std::ptrdiff_t> live{ 0 };
+};
+
+typedef std::unique_ptr<FreePool[]> FreePools;
 
 enum ElementState { Free, Alive, Boundary };
 
@@ -0,0 +1,67 @@
+#include "fileio.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace Utils
+{
+namespace
+{
+/*
+ * Skip the bytes already transferred, leaving parts at the
+ * first part not yet done in full
+ * */
+void advance( iovec*& parts, int& count, size_t bytes )
+{
+  while( count > 0 && bytes >= parts->iov_len ) {
+    bytes -= parts->iov_len;
+    ++parts;
+    --count;
+  }
+
+  if( count > 0 ) {
+    parts->iov_base = static_cast<char*>( parts->iov_base ) + bytes;
+    parts->iov_len -= bytes;
+  }
+}
+}
+
+void writeAll( int fd, iovec* parts, int count )
+{
+  advance( parts, count, 0 );
+
+  while( count > 0 ) {
+    ssize_t written = writev( fd, parts, count );
+
+    if( written < 0 ) {
+      if( errno == EINTR ) continue;
+      throw std::runtime_error( std::string( "cannot write: " ) + std::strerror( errno ) );
+    }
+
+    advance( parts, count, written );
+  }
+}
+
+void readAll( int fd, iovec* parts, int count )
+{
+  advance( parts, count, 0 );
+
+  while( count > 0 ) {
+    ssize_t got = readv( fd, parts, count );
+
+    if( got < 0 ) {
+      if( errno == EINTR ) continue;
+      throw std::runtime_error( std::string( "cannot read: " ) + std::strerror( errno ) );
+    }
+    if( got == 0 ) throw std::runtime_error( "unexpected end of file" );
+
+    advance( parts, count, got );
+  }
+}
+
+/*
+ * End of namespace
+ * */
+}
@@ -0,0 +1,27 @@
+#ifndef FILEIO_HPP_
+#define FILEIO_HPP_
+
+#include <sys/uio.h>
+
+namespace Utils
+{
+
+/*
+ * Write all the parts to fd, in as few writev calls as the kernel
+ * allows: a call that writes part of them is followed by another
+ * for the rest. Throws std::runtime_error when a write fails
+ * */
+void writeAll( int fd, iovec* parts, int count );
+
+/*
+ * Fill all the parts from fd, in as few readv calls as the kernel
+ * allows. Throws std::runtime_error when a read fails or fd ends first
+ * */
+void readAll( int fd, iovec* parts, int count );
+
+/*
+ * End of namespace
+ * */
+}
+
+#endif // FILEIO_HPP_
@@ -0,0 +1,126 @@
+#ifndef GROWTHPOLICIES_HPP_
+#define GROWTHPOLICIES_HPP_
+
+#include "../globals.hpp"
+
+namespace Utils
+{
+
+inline size_t clampBlockSize( size_t size, size_t min, size_t max )
+{
+  return std::min( std::max( size, min ), max );
+}
+
+/*
+ * Growth policies decide how many elements each new block holds.
+ *
+ * A policy provides
+ *  - initial( slot_size ), the size of the first block
+ *  - next( size, slot_size ), the size of the block after one of size
+ *  - minSize() and maxSize(), the limits every block is clamped to
+ * where slot_size is the number of bytes one element takes in a block.
+ * Blocks are never larger than MAX_BLOCK_SIZE so that a slot index
+ * always fits in a Handle
+ * */
+
+/*
+ * Every block is Increment elements larger than the one before
+ * */
+template <size_t Initial = INITIAL_BLOCK_SIZE, size_t Increment = BLOCK_INCREMENT, size_t Min = MIN_BLOCK_SIZE,
+          size_t Max = MAX_BLOCK_SIZE>
+struct LinearGrowth
+{
+  static_assert( Min > 0 && Min <= Max && Max <= MAX_BLOCK_SIZE );
+
+  static size_t minSize( void ) { return Min; }
+  static size_t maxSize( void ) { return Max; }
+  static size_t initial( size_t ) { return clampBlockSize( Initial, Min, Max ); }
+  static size_t next( size_t size, size_t ) { return clampBlockSize( size + Increment, Min, Max ); }
+};
+
+/*
+ * Every block is Num / Den times the size of the one before,
+ * so n elements take O(log n) allocations
+ * */
+template <size_t Initial = INITIAL_BLOCK_SIZE, size_t Num = 2, size_t Den = 1, size_t Min = MIN_BLOCK_SIZE,
+          size_t Max = MAX_BLOCK_SIZE>
+struct GeometricGrowth
+{
+  static_assert( Min > 0 && Min <= Max && Max <= MAX_BLOCK_SIZE );
+  static_assert( Num > Den && Den > 0 );
+
+  static size_t minSize( void ) { return Min; }
+  static size_t maxSize( void ) { return Max; }
+  static size_t initial( size_t ) { return clampBlockSize( Initial, Min, Max ); }
+  static size_t next( size_t size, size_t )
+  {
+    return clampBlockSize( std::max( size + 1, size * Num / Den ), Min, Max );
+  }
+};
+
+/*
+ * Geometric growth that levels off at Cap elements per block, which
+ * bounds the memory a single mostly empty block can hold on to
+ * */
+template <size_t Initial = INITIAL_BLOCK_SIZE, size_t Cap = GROWTH_CAP>
+using CappedGeometricGrowth = GeometricGrowth<Initial, 2, 1, MIN_BLOCK_SIZE, Cap>;
+
+/*
+ * Every block holds Size elements
+ * */
+template <size_t Size = INITIAL_BLOCK_SIZE>
+struct FixedGrowth
+{
+  static_assert( Size > 0 && Size <= MAX_BLOCK_SIZE );
+
+  static size_t minSize( void ) { return Size; }
+  static size_t maxSize( void ) { return Size; }
+  static size_t initial( size_t ) { return Size; }
+  static size_t next( size_t, size_t ) { return Size; }
+};
+
+/*
+ * Blocks are sized so that their elements, Boundaries included,
+ * fill a whole number of PageSize pages. The first block
+ * takes Pages pages and each next block twice as many as the one
+ * before
+ * */
+template <size_t Pages = 1, size_t Min = MIN_BLOCK_SIZE, size_t Max = MAX_BLOCK_SIZE, size_t PageSize = BLOCK_PAGE_SIZE>
+struct PageMultipleGrowth
+{
+  static_assert( Pages > 0 && Min > 0 && Min <= Max && Max <= MAX_BLOCK_SIZE && PageSize > 0 );
+
+  static size_t minSize( void ) { return Min; }
+  static size_t maxSize( void ) { return Max; }
+
+  static size_t pagesFor( size_t size, size_t slot_size )
+  {
+    return ( ( size + 2 ) * slot_size + PageSize - 1 ) / PageSize;
+  }
+
+  static size_t sizeFor( size_t pages, size_t slot_size )
+  {
+    size_t slots = pages * PageSize / slot_size;
+    return slots > 2 ? slots - 2 : 1;
+  }
+
+  static size_t initial( size_t slot_size ) { return clampBlockSize( sizeFor( Pages, slot_size ), Min, Max ); }
+  static size_t next( size_t size, size_t slot_size )
+  {
+    return clampBlockSize( sizeFor( 2 * pagesFor( size, slot_size ), slot_size ), Min, Max );
+  }
+};
+
+/*
+ * Blocks whose elements fill whole HUGE_PAGE_SIZE pages, for
+ * containers whose blocks come from a HugePageResource
+ * */
+template <size_t Pages = 1>
+using HugePageGrowth = PageMultipleGrowth<Pages, MIN_BLOCK_SIZE, MAX_BLOCK_SIZE, HUGE_PAGE_SIZE>;
+
+/*
+ * End of namespace
+ * */
+}
+
+#endif // GROWTHPOLICIES_HPP_
@@ -0,0 +1,170 @@
+#include "hugepages.hpp"
+
+#include <algorithm>
+#include <new>
+
+#include <sys/mman.h>
+
+namespace Utils
+{
+namespace
+{
+size_t roundToHugePages( size_t bytes )
+{
+  return ( bytes + HUGE_PAGE_SIZE - 1 ) & ~( HUGE_PAGE_SIZE - 1 );
+}
+}
+
+HugePageResource::HugePageResource( size_t min_bytes, size_t region_size, std::pmr::memory_resource* upstream )
+    : upstream_( upstream )
+    , min_bytes_( min_bytes )
+    , region_size_( roundToHugePages( std::max<size_t>( region_size, 1 ) ) )
+    , mapped_( 0 )
+    , in_use_( 0 )
+{
+}
+
+HugePageResource::~HugePageResource( void )
+{
+  for( auto& region : regions_ ) {
+    munmap( region.first, region.second );
+  }
+}
+
+/*
+ * Map bytes, a multiple of HUGE_PAGE_SIZE, starting on a huge page
+ * boundary. mmap only promises small page alignment, so one huge
+ * page more is mapped and the ends outside the aligned range are
+ * unmapped again
+ * */
+char* HugePageResource::mapRegion( size_t bytes )
+{
+  size_t padded = bytes + HUGE_PAGE_SIZE;
+  void* raw = mmap( nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+  if( raw == MAP_FAILED ) throw std::bad_alloc();
+
+  char* first = static_cast<char*>( raw );
+  char* base = reinterpret_cast<char*>( roundToHugePages( reinterpret_cast<uintptr_t>( first ) ) );
+  size_t head = base - first;
+  size_t tail = padded - head - bytes;
+
+  if( head ) munmap( first, head );
+  if( tail ) munmap( base + bytes, tail );
+
+#ifdef MADV_HUGEPAGE
+  madvise( base, bytes, MADV_HUGEPAGE );
+#endif
+
+  regions_.emplace_back( base, bytes );
+  mapped_ += bytes;
+  return base;
+}
+
+/*
+ * Put an extent back among the free ones, merged with the
+ * extents right before and after it
+ * */
+void HugePageResource::addFree( char* extent, size_t bytes )
+{
+  auto next = free_.lower_bound( extent );
+
+  if( next != free_.end() && extent + bytes == next->first ) {
+    bytes += next->second;
+    next = free_.erase( next );
+  }
+
+  if( next != free_.begin() ) {
+    auto prev = std::prev( next );
+
+    if( prev->first + prev->second == extent ) {
+      prev->second += bytes;
+      return;
+    }
+  }
+
+  free_.emplace_hint( next, extent, bytes );
+}
+
+/*
+ * Take the first free extent large enough, mapping a new region
+ * if there is none, and keep what is left of it free
+ * */
+void* HugePageResource::do_allocate( size_t bytes, size_t alignment )
+{
+  if( bytes < min_bytes_ || alignment > HUGE_PAGE_SIZE ) return upstream_->allocate( bytes, alignment );
+
+  bytes = roundToHugePages( bytes );
+  std::lock_guard<std::mutex> guard( mutex_ );
+
+  auto firstFit = [&]() -> std::map<char*, size_t>::iterator {
+    auto extent = free_.begin();
+    while( extent != free_.end() && extent->second < bytes ) {
+      ++extent;
+    }
+    return extent;
+  };
+
+  auto extent = firstFit();
+
+  if( extent == free_.end() ) {
+    size_t region = std::max( bytes, region_size_ );
+    addFree( mapRegion( region ), region );
+    extent = firstFit();
+  }
+
+  char* memory = extent->first;
+  size_t rest = extent->second - bytes;
+
+  free_.erase( extent );
+  if( rest ) free_.emplace( memory + bytes, rest );
+
+  in_use_ += bytes;
+  return memory;
+}
+
+/*
+ * Drop the pages of an extent, so the OS gets the memory back while
+ * the range stays mapped for the next allocation to fault in again
+ * */
+void HugePageResource::do_deallocate( void* p, size_t bytes, size_t alignment )
+{
+  if( bytes < min_bytes_ || alignment > HUGE_PAGE_SIZE ) {
+    upstream_->deallocate( p, bytes, alignment );
+    return;
+  }
+
+  bytes = roundToHugePages( bytes );
+  madvise( p, bytes, MADV_DONTNEED );
+
+  std::lock_guard<std::mutex> guard( mutex_ );
+  addFree( static_cast<char*>( p ), bytes );
+  in_use_ -= bytes;
+}
+
+bool HugePageResource::do_is_equal( const std::pmr::memory_resource& other ) const noexcept
+{
+  return this == &other;
+}
+
+/*
+ * Bytes of address space mapped so far
+ * */
+size_t HugePageResource::mapped( void ) const
+{
+  std::lock_guard<std::mutex> guard( mutex_ );
+  return mapped_;
+}
+
+/*
+ * Bytes handed out in huge pages and not yet given back
+ * */
+size_t HugePageResource::inUse( void ) const
+{
+  std::lock_guard<std::mutex> guard( mutex_ );
+  return in_use_;
+}
+
+/*
+ * End of namespace
+ * */
+}
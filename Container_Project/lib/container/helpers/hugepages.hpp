@@ -0,0 +1,75 @@
+#ifndef HUGEPAGES_HPP_
+#define HUGEPAGES_HPP_
+
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+#include "../globals.hpp"
+
+namespace Utils
+{
+
+/*
+ * A memory resource for containers of hundreds of millions of
+ * elements, meant for pmr::VectorList.
+ *
+ * Allocations of at least min_bytes are carved out of large mmap
+ * regions marked MADV_HUGEPAGE, each starting on a HUGE_PAGE_SIZE
+ * boundary and rounded up to whole huge pages, so a scan over a
+ * block takes one TLB entry per 2 MiB rather than per 4 KiB.
+ * Smaller allocations, such as the lock arrays of small blocks, go
+ * to the upstream resource.
+ *
+ * Deallocated extents are given back to the OS with MADV_DONTNEED
+ * but stay mapped, merged with free neighbours, and are handed out
+ * again first fit. Regions are only unmapped when the resource is
+ * destroyed, so it must outlive every container using it.
+ * Every call takes a mutex, which is fine for blocks as they are
+ * allocated and trimmed rarely
+ * */
+class HugePageResource : public std::pmr::memory_resource
+{
+  private:
+  std::pmr::memory_resource* upstream_;
+  size_t min_bytes_;
+  size_t region_size_;
+
+  mutable std::mutex mutex_;
+
+  // every mapped region, as { base, bytes }
+  std::vector<std::pair<char*, size_t> > regions_;
+
+  // unused extents by address, never touching one another
+  std::map<char*, size_t> free_;
+
+  size_t mapped_;
+  size_t in_use_;
+
+  char* mapRegion( size_t bytes );
+  void addFree( char* extent, size_t bytes );
+
+  protected:
+  void* do_allocate( size_t bytes, size_t alignment ) override;
+  void do_deallocate( void* p, size_t bytes, size_t alignment ) override;
+  bool do_is_equal( const std::pmr::memory_resource& other ) const noexcept override;
+
+  public:
+  explicit HugePageResource( size_t min_bytes = HUGE_PAGE_SIZE, size_t region_size = HUGE_REGION_SIZE,
+                             std::pmr::memory_resource* upstream = std::pmr::new_delete_resource() );
+  ~HugePageResource( void );
+
+  HugePageResource( const HugePageResource& ) = delete;
+  HugePageResource& operator=( const HugePageResource& ) = delete;
+
+  size_t mapped( void ) const;
+  size_t inUse( void ) const;
+};
+
+/*
+ * End of namespace
+ * */
+}
+
+#endif // HUGEPAGES_HPP_
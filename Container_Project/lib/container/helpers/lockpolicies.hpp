@@ -0,0 +1,250 @@
+#ifndef LOCKPOLICIES_HPP_
+#define LOCKPOLICIES_HPP_
+
+#include <thread>
+#include <atomic>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#endif
+
+#include "../globals.hpp"
+
+namespace Utils
+{
+
+void spinLock( std::atomic_flag& lock );
+bool trySpinLock( std::atomic_flag& lock );
+void spinUnlock( std::atomic_flag& lock );
+
+/*
+ * Tell the CPU we are in a spin-wait loop so it can
+ * back off the memory bus and give a sibling hyperthread
+ * the core
+ * */
+inline void cpuRelax( void )
+{
+#if defined( __x86_64__ ) || defined( __i386__ )
+  _mm_pause();
+#elif defined( __aarch64__ ) || defined( __arm__ )
+  asm volatile( "yield" );
+#endif
+}
+
+/*
+ * Contention counters kept per lock policy. Only acquisitions
+ * that fail their first attempt touch them, and each of those
+ * publishes its totals once, so the counters stay off the
+ * uncontended path
+ * */
+struct LockStats
+{
+  std::atomic<size_t> contended{ 0 };
+  std::atomic<size_t> spins{ 0 };
+  std::atomic<size_t> yields{ 0 };
+  std::atomic<size_t> waits{ 0 };
+
+  void record( size_t num_spins, size_t num_yields, size_t num_waits )
+  {
+    contended.fetch_add( 1, std::memory_order_relaxed );
+    spins.fetch_add( num_spins, std::memory_order_relaxed );
+    yields.fetch_add( num_yields, std::memory_order_relaxed );
+    waits.fetch_add( num_waits, std::memory_order_relaxed );
+  }
+
+  void reset( void )
+  {
+    contended.store( 0, std::memory_order_relaxed );
+    spins.store( 0, std::memory_order_relaxed );
+    yields.store( 0, std::memory_order_relaxed );
+    waits.store( 0, std::memory_order_relaxed );
+  }
+};
+
+/*
+ * Plain test-and-set loop. Cheapest when locks are held
+ * for a handful of instructions by fewer threads than cores
+ * */
+struct SpinPolicy
+{
+  static LockStats& stats( void )
+  {
+    static LockStats lock_stats;
+    return lock_stats;
+  }
+
+  static void lock( std::atomic_flag& lock )
+  {
+    if( trySpinLock( lock ) ) return;
+
+    size_t spins = 0;
+    while( lock.test_and_set( std::memory_order_acquire ) ) {
+      ++spins;
+    }
+
+    stats().record( spins, 0, 0 );
+  }
+
+  static bool tryLock( std::atomic_flag& lock )
+  {
+    return trySpinLock( lock );
+  }
+
+  static void unlock( std::atomic_flag& lock )
+  {
+    spinUnlock( lock );
+  }
+};
+
+/*
+ * Test-and-test-and-set. Waiting threads spin on a plain load
+ * so the cache line stays shared until the lock is released,
+ * pausing between reads and yielding the CPU every
+ * YIELD_SPIN_LIMIT spins in case the holder was preempted
+ * */
+struct YieldPolicy
+{
+  static LockStats& stats( void )
+  {
+    static LockStats lock_stats;
+    return lock_stats;
+  }
+
+  static void lock( std::atomic_flag& lock )
+  {
+    if( tryLock( lock ) ) return;
+
+    size_t spins = 0;
+    size_t yields = 0;
+
+    do {
+      while( lock.test( std::memory_order_relaxed ) ) {
+        if( ++spins % YIELD_SPIN_LIMIT == 0 ) {
+          ++yields;
+          std::this_thread::yield();
+        } else {
+          cpuRelax();
+        }
+      }
+    } while( lock.test_and_set( std::memory_order_acquire ) );
+
+    stats().record( spins, yields, 0 );
+  }
+
+  static bool tryLock( std::atomic_flag& lock )
+  {
+    return !lock.test( std::memory_order_relaxed ) && trySpinLock( lock );
+  }
+
+  static void unlock( std::atomic_flag& lock )
+  {
+    spinUnlock( lock );
+  }
+};
+
+/*
+ * Test-and-test-and-set with bounded exponential backoff.
+ * Each failed attempt doubles the number of pauses before the
+ * next one up to MAX_BACKOFF_PAUSES, after which the thread
+ * yields between attempts instead
+ * */
+struct BackoffPolicy
+{
+  static LockStats& stats( void )
+  {
+    static LockStats lock_stats;
+    return lock_stats;
+  }
+
+  static void lock( std::atomic_flag& lock )
+  {
+    if( tryLock( lock ) ) return;
+
+    size_t spins = 0;
+    size_t yields = 0;
+    size_t pauses = 1;
+
+    do {
+      while( lock.test( std::memory_order_relaxed ) ) {
+        if( pauses > MAX_BACKOFF_PAUSES ) {
+          ++yields;
+          std::this_thread::yield();
+          continue;
+        }
+
+        for( size_t i = 0; i < pauses; ++i ) {
+          cpuRelax();
+        }
+
+        spins += pauses;
+        pauses *= 2;
+      }
+    } while( lock.test_and_set( std::memory_order_acquire ) );
+
+    stats().record( spins, yields, 0 );
+  }
+
+  static bool tryLock( std::atomic_flag& lock )
+  {
+    return !lock.test( std::memory_order_relaxed ) && trySpinLock( lock );
+  }
+
+  static void unlock( std::atomic_flag& lock )
+  {
+    spinUnlock( lock );
+  }
+};
+
+/*
+ * Spins briefly, then sleeps in std::atomic_flag::wait (a futex
+ * on Linux) until the holder releases the lock. Suited to long
+ * critical sections or more runnable threads than cores.
+ * Unlocking always notifies, which costs a little even when
+ * nobody is waiting
+ * */
+struct WaitPolicy
+{
+  static LockStats& stats( void )
+  {
+    static LockStats lock_stats;
+    return lock_stats;
+  }
+
+  static void lock( std::atomic_flag& lock )
+  {
+    if( tryLock( lock ) ) return;
+
+    size_t spins = 0;
+    size_t waits = 0;
+
+    while( lock.test_and_set( std::memory_order_acquire ) ) {
+      if( spins < YIELD_SPIN_LIMIT ) {
+        ++spins;
+        cpuRelax();
+      } else {
+        ++waits;
+        lock.wait( true, std::memory_order_relaxed );
+      }
+    }
+
+    stats().record( spins, 0, waits );
+  }
+
+  static bool tryLock( std::atomic_flag& lock )
+  {
+    return !lock.test( std::memory_order_relaxed ) && trySpinLock( lock );
+  }
+
+  static void unlock( std::atomic_flag& lock )
+  {
+    spinUnlock( lock );
+    lock.notify_one();
+  }
+};
+
+/*
+ * End of namespace
+ * */
+}
+
+#endif // LOCKPOLICIES_HPP_
@@ -0,0 +1,317 @@
+#include "mappedfile.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Utils
+{
+namespace
+{
+// "VLISTMA" followed by the version of the layout in the last byte
+const uint64_t file_magic = 0x564c4953544d4100 | 4;
+
+size_t roundTo( size_t bytes, size_t unit )
+{
+  return ( bytes + unit - 1 ) / unit * unit;
+}
+
+std::runtime_error fileError( const std::string& what, const std::string& path )
+{
+  return std::runtime_error( what + " " + path + ": " + std::strerror( errno ) );
+}
+}
+
+MappedFile::MappedFile( const std::string& path, MapMode mode, size_t max_bytes )
+    : fd_( -1 )
+    , base_( nullptr )
+    , max_bytes_( roundTo( max_bytes, BLOCK_PAGE_SIZE ) )
+    , file_bytes_( 0 )
+    , mode_( mode )
+{
+  int flags = mode == MapMode::Create ? O_RDWR | O_CREAT : mode == MapMode::Open ? O_RDWR : O_RDONLY;
+
+  fd_ = open( path.c_str(), flags, 0644 );
+  if( fd_ < 0 ) throw fileError( "cannot open", path );
+
+  if( flock( fd_, ( mode == MapMode::ReadOnly ? LOCK_SH : LOCK_EX ) | LOCK_NB ) != 0 ) {
+    std::runtime_error error = fileError( "cannot lock", path );
+    close( fd_ );
+    throw error;
+  }
+
+  // truncated only once no one else has the file open
+  if( mode == MapMode::Create && ftruncate( fd_, 0 ) != 0 ) {
+    std::runtime_error error = fileError( "cannot truncate", path );
+    close( fd_ );
+    throw error;
+  }
+
+  struct stat info;
+  if( fstat( fd_, &info ) != 0 ) {
+    close( fd_ );
+    throw fileError( "cannot stat", path );
+  }
+  file_bytes_ = info.st_size;
+  max_bytes_ = std::max( max_bytes_, roundTo( file_bytes_, BLOCK_PAGE_SIZE ) );
+
+  int protection = PROT_READ | PROT_WRITE;
+  int sharing = mode == MapMode::ReadOnly ? MAP_PRIVATE : MAP_SHARED;
+  void* base = mmap( nullptr, max_bytes_, protection, sharing | MAP_NORESERVE, fd_, 0 );
+
+  if( base == MAP_FAILED ) {
+    close( fd_ );
+    throw fileError( "cannot map", path );
+  }
+  base_ = static_cast<char*>( base );
+
+  if( mode == MapMode::Create ) {
+    try {
+      growTo( MAPPED_FILE_GROWTH );
+    } catch( ... ) {
+      munmap( base_, max_bytes_ );
+      close( fd_ );
+      throw;
+    }
+
+    *header() = Header{ file_magic, CACHE_LINE_SIZE, 0, 0, 1 };
+    return;
+  }
+
+  if( file_bytes_ < sizeof( Header ) || header()->magic != file_magic || header()->used > file_bytes_ ) {
+    munmap( base_, max_bytes_ );
+    close( fd_ );
+    throw std::runtime_error( "not a mapped container file " + path );
+  }
+}
+
+MappedFile::~MappedFile( void )
+{
+  if( mode_ != MapMode::ReadOnly ) msync( base_, file_bytes_, MS_SYNC );
+  munmap( base_, max_bytes_ );
+  close( fd_ );
+}
+
+MappedFile::Header* MappedFile::header( void ) const
+{
+  return reinterpret_cast<Header*>( base_ );
+}
+
+/*
+ * Extend the file to at least bytes, a MAPPED_FILE_GROWTH at a time.
+ * The pages were mapped already, only the file behind them is new
+ * */
+void MappedFile::growTo( size_t bytes )
+{
+  if( bytes <= file_bytes_ ) return;
+  if( bytes > max_bytes_ ) throw std::bad_alloc();
+
+  size_t size = std::min( roundTo( bytes, MAPPED_FILE_GROWTH ), max_bytes_ );
+  if( ftruncate( fd_, size ) != 0 ) throw std::bad_alloc();
+
+  file_bytes_ = size;
+}
+
+/*
+ * Take the first free extent large enough, splitting off what is
+ * left of it, else carve the memory from the end of the used bytes.
+ * A ReadOnly file cannot grow, its memory comes from the heap
+ * */
+void* MappedFile::do_allocate( size_t bytes, size_t alignment )
+{
+  if( mode_ == MapMode::ReadOnly ) return std::pmr::new_delete_resource()->allocate( bytes, alignment );
+  if( alignment > CACHE_LINE_SIZE ) throw std::bad_alloc();
+
+  bytes = roundTo( std::max<size_t>( bytes, 1 ), CACHE_LINE_SIZE );
+  std::lock_guard<std::mutex> guard( mutex_ );
+
+  Header* head = header();
+  uint64_t* link = &head->free;
+
+  while( *link ) {
+    FreeExtent* extent = static_cast<FreeExtent*>( at( *link, sizeof( FreeExtent ) ) );
+
+    if( extent->size >= bytes ) {
+      uint64_t offset = *link;
+
+      if( extent->size > bytes ) {
+        FreeExtent* rest = static_cast<FreeExtent*>( at( offset + bytes, sizeof( FreeExtent ) ) );
+        *rest = FreeExtent{ extent->size - bytes, extent->next };
+        *link = offset + bytes;
+      } else {
+        *link = extent->next;
+      }
+
+      return at( offset, bytes );
+    }
+
+    link = &extent->next;
+  }
+
+  growTo( head->used + bytes );
+
+  uint64_t offset = head->used;
+  head->used += bytes;
+  return at( offset, bytes );
+}
+
+/*
+ * Insert the memory into the free extents, which stay in address
+ * order across closing and opening the file again. It is merged
+ * with the extents right before and after it, and memory at the end
+ * of the used bytes goes back to them instead.
+ * A ReadOnly file only gives back what came from the heap
+ * */
+void MappedFile::do_deallocate( void* p, size_t bytes, size_t alignment )
+{
+  if( mode_ == MapMode::ReadOnly ) {
+    char* byte = static_cast<char*>( p );
+    if( byte < base_ || byte >= base_ + max_bytes_ ) std::pmr::new_delete_resource()->deallocate( p, bytes, alignment );
+    return;
+  }
+
+  bytes = roundTo( std::max<size_t>( bytes, 1 ), CACHE_LINE_SIZE );
+  std::lock_guard<std::mutex> guard( mutex_ );
+
+  Header* head = header();
+  uint64_t offset = offsetOf( p );
+
+  // link ends up as the link to the extent holding the memory
+  uint64_t* link = &head->free;
+  uint64_t* previous_link = nullptr;
+  FreeExtent* previous = nullptr;
+
+  while( *link && *link < offset ) {
+    previous_link = link;
+    previous = static_cast<FreeExtent*>( at( *link, sizeof( FreeExtent ) ) );
+    link = &previous->next;
+  }
+
+  FreeExtent* extent = static_cast<FreeExtent*>( p );
+  *extent = FreeExtent{ bytes, *link };
+
+  if( extent->next && offset + extent->size == extent->next ) {
+    FreeExtent* next = static_cast<FreeExtent*>( at( extent->next, sizeof( FreeExtent ) ) );
+    *extent = FreeExtent{ extent->size + next->size, next->next };
+  }
+
+  if( previous && offsetOf( previous ) + previous->size == offset ) {
+    *previous = FreeExtent{ previous->size + extent->size, extent->next };
+    extent = previous;
+    offset = *previous_link;
+    link = previous_link;
+  } else {
+    *link = offset;
+  }
+
+  // an extent at the end is not kept, the used bytes end before it
+  if( offset + extent->size == head->used ) {
+    head->used = offset;
+    *link = 0;
+  }
+}
+
+bool MappedFile::do_is_equal( const std::pmr::memory_resource& other ) const noexcept
+{
+  return this == &other;
+}
+
+bool MappedFile::readOnly( void ) const
+{
+  return mode_ == MapMode::ReadOnly;
+}
+
+/*
+ * Bytes of the file in use, the header and free extents included
+ * */
+size_t MappedFile::used( void ) const
+{
+  return header()->used;
+}
+
+uint64_t MappedFile::offsetOf( const void* p ) const
+{
+  return static_cast<const char*>( p ) - base_;
+}
+
+/*
+ * The memory of bytes bytes at offset in the file. Offsets are read
+ * from the file, so one that leads past its end throws
+ * std::runtime_error rather than reaching unmapped pages
+ * */
+void* MappedFile::at( uint64_t offset, size_t bytes ) const
+{
+  if( offset > file_bytes_ || bytes > file_bytes_ - offset ) throw std::runtime_error( "an offset runs past the end of the mapped file" );
+  return base_ + offset;
+}
+
+/*
+ * Offset of the object the user keeps its state in,
+ * 0 while there is none
+ * */
+uint64_t MappedFile::root( void ) const
+{
+  return header()->root;
+}
+
+void MappedFile::setRoot( uint64_t offset )
+{
+  header()->root = offset;
+}
+
+/*
+ * Whether the state at the root was left as its owner last wrote
+ * it. A new file is clean
+ * */
+bool MappedFile::clean( void ) const
+{
+  return header()->clean;
+}
+
+/*
+ * Mark the state at the root clean or not and write the header back
+ * to the file at once, so the mark is on disk before any change it
+ * covers. An owner marks it dirty before it changes the state in
+ * place and clean once it wrote all of it back, so a file whose
+ * owner crashed in between opens dirty. A ReadOnly file keeps
+ * the mark to itself. If the header cannot be flushed, the file is
+ * left marked dirty and std::system_error is thrown
+ * */
+void MappedFile::setClean( bool clean )
+{
+  header()->clean = clean;
+  if( mode_ == MapMode::ReadOnly ) return;
+
+  if( msync( base_, sizeof( Header ), MS_SYNC ) != 0 ) {
+    int error = errno;
+    header()->clean = false;
+    throw std::system_error( error, std::generic_category(), "cannot flush the header of a mapped file" );
+  }
+}
+
+/*
+ * Write the mapped pages back to the file. Throws std::system_error
+ * if they could not all be written
+ * */
+void MappedFile::sync( void )
+{
+  if( mode_ == MapMode::ReadOnly ) return;
+
+  if( msync( base_, file_bytes_, MS_SYNC ) != 0 ) {
+    throw std::system_error( errno, std::generic_category(), "cannot flush a mapped file" );
+  }
+}
+
+/*
+ * End of namespace
+ * */
+}
@@ -0,0 +1,115 @@
+#ifndef MAPPEDFILE_HPP_
+#define MAPPEDFILE_HPP_
+
+#include <memory_resource>
+#include <mutex>
+#include <string>
+
+#include "../globals.hpp"
+
+namespace Utils
+{
+
+enum class MapMode
+{
+  // make a new, empty file, replacing any file at the path
+  Create,
+  // open an existing file for reading and writing
+  Open,
+  // open an existing file whose changes stay in this process
+  ReadOnly
+};
+
+/*
+ * A memory resource whose memory is a file mapped into the process.
+ *
+ * The file may be mapped at a different address every time, so
+ * nothing stored in it may hold a pointer into it. Everything the
+ * resource keeps in the file refers to other parts of it by their
+ * offset from the start of the file:
+ *  - a header with the bytes in use, the first free extent, the
+ *    root, the offset of whatever the user keeps its state in, and
+ *    whether that state is clean, see setClean()
+ *  - free extents, each starting with its size and the offset of
+ *    the next one
+ *
+ * Allocations are CACHE_LINE_SIZE aligned and taken first fit from
+ * the free extents, else from the end of the used bytes, growing
+ * the file as needed. Free extents are kept in address order and
+ * merged when they meet.
+ * A range of max_bytes of address space is reserved up front so
+ * growing the file never moves the mapping.
+ *
+ * A ReadOnly file is mapped private: it can be read by many
+ * processes at once, and whatever is written to it is private to the
+ * process and dropped at unmapping. What is allocated from it comes
+ * from the heap instead.
+ *
+ * A file is opened under an flock, shared for ReadOnly and exclusive
+ * otherwise, so it has either one writer or any number of readers.
+ * Opening a file held the other way throws std::runtime_error
+ * rather than waiting, also within one process. A reader thus never
+ * sees a dirty file that is still being written
+ * */
+class MappedFile : public std::pmr::memory_resource
+{
+  private:
+  struct Header
+  {
+    uint64_t magic;
+    uint64_t used;
+    uint64_t free;
+    uint64_t root;
+    uint64_t clean;
+  };
+
+  struct FreeExtent
+  {
+    uint64_t size;
+    uint64_t next;
+  };
+
+  int fd_;
+  char* base_;
+  size_t max_bytes_;
+  size_t file_bytes_;
+  MapMode mode_;
+
+  std::mutex mutex_;
+
+  Header* header( void ) const;
+  void growTo( size_t bytes );
+
+  protected:
+  void* do_allocate( size_t bytes, size_t alignment ) override;
+  void do_deallocate( void* p, size_t bytes, size_t alignment ) override;
+  bool do_is_equal( const std::pmr::memory_resource& other ) const noexcept override;
+
+  public:
+  MappedFile( const std::string& path, MapMode mode, size_t max_bytes = MAPPED_FILE_RESERVE );
+  ~MappedFile( void );
+
+  MappedFile( const MappedFile& ) = delete;
+  MappedFile& operator=( const MappedFile& ) = delete;
+
+  bool readOnly( void ) const;
+  size_t used( void ) const;
+
+  uint64_t offsetOf( const void* p ) const;
+  void* at( uint64_t offset, size_t bytes ) const;
+
+  uint64_t root( void ) const;
+  void setRoot( uint64_t offset );
+
+  bool clean( void ) const;
+  void setClean( bool clean );
+
+  void sync( void );
+};
+
+/*
+ * End of namespace
+ * */
+}
+
+#endif // MAPPEDFILE_HPP_
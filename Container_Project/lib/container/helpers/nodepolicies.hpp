@@ -0,0 +1,96 @@
+#ifndef NODEPOLICIES_HPP_
+#define NODEPOLICIES_HPP_
+
+#include "../globals.hpp"
+#include "./utils.hpp"
+
+#ifdef CONTAINER_HAVE_NUMA
+#include <numa.h>
+#include <sched.h>
+#endif
+
+namespace Utils
+{
+
+/*
+ * Node policies tell a VectorList which NUMA node the calling thread
+ * runs on, so that it can keep the blocks, and the free slots, of
+ * each node apart.
+ *
+ * A policy provides
+ *  - nodes(), the number of nodes, at most MAX_NUMA_NODES are used
+ *  - currentNode(), the node of the calling thread, below nodes()
+ *  - bind( memory, bytes, node ), asking for the pages of a new block
+ *    to be placed on node before they are first written
+ * */
+
+/*
+ * The machine is treated as a single node, which is what
+ * VectorList did before it knew about nodes
+ * */
+struct SingleNode
+{
+  static size_t nodes( void ) { return 1; }
+  static size_t currentNode( void ) { return 0; }
+  static void bind( void*, size_t, size_t ) {}
+};
+
+/*
+ * A made up topology of Nodes nodes, thread index i being on node
+ * i % Nodes. Memory is not bound anywhere. It lets the per-node
+ * bookkeeping be exercised on a machine with a single node
+ * */
+template <size_t Nodes = 2>
+struct FakeNodes
+{
+  static_assert( Nodes > 0 && Nodes <= MAX_NUMA_NODES );
+
+  static size_t nodes( void ) { return Nodes; }
+  static size_t currentNode( void ) { return threadIndex() % Nodes; }
+  static void bind( void*, size_t, size_t ) {}
+};
+
+#ifdef CONTAINER_HAVE_NUMA
+/*
+ * The topology reported by libnuma. The node of a thread is the
+ * node of the cpu it runs on right now, so a thread the scheduler
+ * moves takes its new node with it at its next refill.
+ * Only the whole pages inside a block are bound, the pages it
+ * shares with other allocations are left alone
+ * */
+struct NumaNodes
+{
+  static size_t nodes( void )
+  {
+    static const size_t count =
+      numa_available() < 0 ? 1 : std::min<size_t>( numa_max_node() + 1, MAX_NUMA_NODES );
+    return count;
+  }
+
+  static size_t currentNode( void )
+  {
+    if( nodes() == 1 ) return 0;
+
+    int cpu = sched_getcpu();
+    int node = cpu < 0 ? 0 : numa_node_of_cpu( cpu );
+    return node < 0 ? 0 : static_cast<size_t>( node ) % nodes();
+  }
+
+  static void bind( void* memory, size_t bytes, size_t node )
+  {
+    if( nodes() == 1 ) return;
+
+    uintptr_t first = ( reinterpret_cast<uintptr_t>( memory ) + BLOCK_PAGE_SIZE - 1 ) & ~uintptr_t( BLOCK_PAGE_SIZE - 1 );
+    uintptr_t last = ( reinterpret_cast<uintptr_t>( memory ) + bytes ) & ~uintptr_t( BLOCK_PAGE_SIZE - 1 );
+
+    if( first < last ) numa_tonode_memory( reinterpret_cast<void*>( first ), last - first, static_cast<int>( node ) );
+  }
+};
+#endif
+
+/*
+ * End of namespace
+ * */
+}
+
+#endif // NODEPOLICIES_HPP_
@@ -0,0 +1,173 @@
+#include "parallel.hpp"
+
+#include <algorithm>
+
+namespace Utils
+{
+namespace
+{
+// set while a thread runs a part of a WorkerPool run
+thread_local bool in_run = false;
+
+/*
+ * Flags the calling thread as running a part of a run
+ * until the end of the scope
+ * */
+struct RunScope
+{
+  bool outer;
+
+  RunScope( void )
+      : outer( in_run )
+  {
+    in_run = true;
+  }
+
+  ~RunScope( void ) { in_run = outer; }
+};
+}
+
+WorkerPool::WorkerPool( void )
+    : job_( nullptr )
+    , job_threads_( 0 )
+    , next_( 0 )
+    , pending_( 0 )
+    , stopping_( false )
+{
+}
+
+WorkerPool::~WorkerPool( void )
+{
+  {
+    std::lock_guard<std::mutex> guard( lock_ );
+    stopping_ = true;
+  }
+  wake_.notify_all();
+
+  for( auto& thread : threads_ ) {
+    thread.join();
+  }
+}
+
+/*
+ * Run the next part of the current run, with lock_ held by guard,
+ * which is let go while the part runs
+ * */
+void WorkerPool::runPart( std::unique_lock<std::mutex>& guard )
+{
+  size_t t = next_++;
+  const std::function<void( size_t )>& job = *job_;
+
+  guard.unlock();
+  job( t );
+  guard.lock();
+
+  if( --pending_ == 0 ) done_.notify_one();
+}
+
+/*
+ * Loop of a worker thread: claim the next part of the current
+ * run, if any is left, or sleep until there is one
+ * */
+void WorkerPool::work( void )
+{
+  RunScope scope;
+  std::unique_lock<std::mutex> guard( lock_ );
+
+  for( ;; ) {
+    wake_.wait( guard, [this]( void ) -> bool { return stopping_ || next_ < job_threads_; } );
+    if( stopping_ ) return;
+
+    runPart( guard );
+  }
+}
+
+/*
+ * Most worker threads the pool keeps, so that with the calling
+ * thread a run uses at most one thread per core
+ * */
+size_t WorkerPool::maxWorkers( void )
+{
+  return std::max<size_t>( 2, std::thread::hardware_concurrency() ) - 1;
+}
+
+void WorkerPool::run( size_t num_threads, const std::function<void( size_t )>& worker )
+{
+  if( num_threads <= 1 ) {
+    if( num_threads ) worker( 0 );
+    return;
+  }
+
+  if( in_run ) {
+    std::vector<std::thread> threads;
+    threads.reserve( num_threads - 1 );
+
+    try {
+      for( size_t t = 1; t < num_threads; ++t ) {
+        threads.emplace_back( worker, t );
+      }
+    } catch( ... ) {
+      for( auto& thread : threads ) {
+        thread.join();
+      }
+      throw;
+    }
+
+    worker( 0 );
+
+    for( auto& thread : threads ) {
+      thread.join();
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> run_guard( run_lock_ );
+  RunScope scope;
+
+  {
+    std::lock_guard<std::mutex> guard( lock_ );
+
+    while( threads_.size() < std::min( num_threads - 1, maxWorkers() ) ) {
+      threads_.emplace_back( &WorkerPool::work, this );
+    }
+
+    job_ = &worker;
+    job_threads_ = num_threads;
+    next_ = 1;
+    pending_ = num_threads - 1;
+  }
+  wake_.notify_all();
+
+  worker( 0 );
+
+  // parts left over by the workers are run by the caller too
+  std::unique_lock<std::mutex> guard( lock_ );
+  while( next_ < job_threads_ ) {
+    runPart( guard );
+  }
+  done_.wait( guard, [this]( void ) -> bool { return pending_ == 0; } );
+
+  job_ = nullptr;
+  job_threads_ = 0;
+  next_ = 0;
+}
+
+/*
+ * Number of worker threads started so far
+ * */
+size_t WorkerPool::size( void )
+{
+  std::lock_guard<std::mutex> guard( lock_ );
+  return threads_.size();
+}
+
+WorkerPool& WorkerPool::shared( void )
+{
+  static WorkerPool pool;
+  return pool;
+}
+
+/*
+ * End of namespace
+ * */
+}
@@ -0,0 +1,120 @@
+#ifndef PARALLEL_HPP_
+#define PARALLEL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../globals.hpp"
+
+namespace Utils
+{
+
+/*
+ * A run of bitmap words [first_word, last_word) of one block,
+ * the unit of work handed to the threads of a parallel algorithm
+ * */
+struct BlockChunk
+{
+  size_t block;
+  size_t first_word;
+  size_t last_word;
+};
+
+/*
+ * Number of threads to use for num_chunks chunks when
+ * num_threads were asked for, 0 meaning one per core
+ * */
+inline size_t parallelThreads( size_t num_threads, size_t num_chunks )
+{
+  if( num_threads == 0 ) num_threads = std::max<size_t>( 1, std::thread::hardware_concurrency() );
+  return std::max<size_t>( 1, std::min( num_threads, num_chunks ) );
+}
+
+/*
+ * Threads kept alive between parallel algorithms so a call does not
+ * pay for creating and joining its threads.
+ *
+ * run( num_threads, worker ) calls worker( t ) for t in
+ * [0, num_threads), the calling thread being thread 0, and returns
+ * once every call has. Workers are started the first time a run
+ * needs them and then wait for the next run. The pool never holds
+ * more workers than one fewer than the cores, so a run asking for
+ * more threads than that runs several parts on the same thread, one
+ * after the other, and its parts must not wait for each other.
+ * Runs from different threads take turns, so the parallel
+ * algorithms of all containers in the process run one at a time.
+ * A run started from inside a worker of another run cannot wait for
+ * the pool, which is busy with its caller, so it gets threads of
+ * its own for the duration of the run.
+ * worker must not throw
+ * */
+class WorkerPool
+{
+  private:
+  std::mutex run_lock_;
+
+  // guards everything below
+  std::mutex lock_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  std::vector<std::thread> threads_;
+  const std::function<void( size_t )>* job_;
+  size_t job_threads_;
+  size_t next_;
+  size_t pending_;
+  bool stopping_;
+
+  void runPart( std::unique_lock<std::mutex>& guard );
+  void work( void );
+  static size_t maxWorkers( void );
+
+  public:
+  WorkerPool( void );
+  ~WorkerPool( void );
+
+  WorkerPool( const WorkerPool& ) = delete;
+  WorkerPool& operator=( const WorkerPool& ) = delete;
+
+  void run( size_t num_threads, const std::function<void( size_t )>& worker );
+  size_t size( void );
+
+  // the pool the parallel algorithms run on
+  static WorkerPool& shared( void );
+};
+
+/*
+ * Run worker( t ) for t in [0, num_threads) on the shared
+ * WorkerPool, the calling thread being thread 0, and wait for
+ * all of them. The first exception thrown by a worker is rethrown
+ * once every thread has finished, the others are dropped
+ * */
+template <class F>
+void parallelRun( size_t num_threads, F&& worker )
+{
+  std::exception_ptr error;
+  std::atomic_flag failed = ATOMIC_FLAG_INIT;
+
+  auto guarded = [&]( size_t t ) -> void {
+    try {
+      worker( t );
+    } catch( ... ) {
+      if( !failed.test_and_set( std::memory_order_relaxed ) ) error = std::current_exception();
+    }
+  };
+
+  WorkerPool::shared().run( num_threads, guarded );
+
+  if( error ) std::rethrow_exception( error );
+}
+
+/*
+ * End of namespace
+ * */
+}
+
+#endif // PARALLEL_HPP_
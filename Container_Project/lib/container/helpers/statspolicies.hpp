@@ -0,0 +1,181 @@
+#ifndef STATSPOLICIES_HPP_
+#define STATSPOLICIES_HPP_
+
+#include "../globals.hpp"
+#include "./utils.hpp"
+#include "./lockpolicies.hpp"
+
+namespace Utils
+{
+
+/*
+ * Events a stats policy counts
+ *  - BlocksPushed, blocks added to the container
+ *  - Refills and Flushes, batches moved between a thread's
+ *    cache and the shared pool
+ *  - IterationSteps, steps taken by iterators
+ *  - SlotsSkipped, Free slots iterators stepped over
+ *  - Relocations, elements moved by compact()
+ *  - CachedFree, the free slots a thread holds in its cache,
+ *    a gauge rather than a count
+ * */
+enum class Stat
+{
+  BlocksPushed,
+  Refills,
+  Flushes,
+  IterationSteps,
+  SlotsSkipped,
+  Relocations,
+  CachedFree,
+  NumStats
+};
+
+/*
+ * Stats policies decide whether a VectorList counts what it does.
+ *
+ * A policy provides
+ *  - enabled, whether anything is counted
+ *  - add( stat, n ) and set( stat, n ), called from the hot paths
+ *  - a Sink type, a copyable reference to the policy that
+ *    iterators carry around
+ * */
+
+/*
+ * Counts nothing. Every call compiles away and
+ * iterators carry an empty Sink
+ * */
+struct NoStats
+{
+  static constexpr bool enabled = false;
+
+  struct Sink
+  {
+    Sink( void ) {}
+    Sink( NoStats* ) {}
+
+    void add( Stat, size_t ) const {}
+  };
+
+  void add( Stat, size_t ) {}
+  void set( Stat, size_t ) {}
+};
+
+/*
+ * Counts every event in counters owned by the calling thread, so
+ * counting never makes two threads write the same cache line.
+ * Threads beyond MAX_THREAD_CACHES share one last set of counters.
+ * Totals are only summed up when asked for
+ * */
+class CountingStats
+{
+  private:
+  struct alignas( CACHE_LINE_SIZE ) Counters
+  {
+    std::atomic<size_t> values[static_cast<size_t>( Stat::NumStats )];
+  };
+
+  std::unique_ptr<Counters[]> counters_;
+
+  public:
+  static constexpr bool enabled = true;
+
+  class Sink
+  {
+    private:
+    CountingStats* stats_;
+
+    public:
+    Sink( void )
+        : stats_( nullptr )
+    {
+    }
+
+    Sink( CountingStats* stats )
+        : stats_( stats )
+    {
+    }
+
+    void add( Stat stat, size_t n ) const
+    {
+      if( stats_ ) stats_->add( stat, n );
+    }
+  };
+
+  CountingStats( void )
+      : counters_( new Counters[MAX_THREAD_CACHES + 1]() )
+  {
+  }
+
+  /*
+   * Only the owner writes its counters,
+   * so no read-modify-write is needed
+   * */
+  void add( Stat stat, size_t n )
+  {
+    size_t thread = threadIndex();
+    std::atomic<size_t>& value = counters_[std::min<size_t>( thread, MAX_THREAD_CACHES )].values[static_cast<size_t>( stat )];
+
+    if( thread < MAX_THREAD_CACHES ) {
+      value.store( value.load( std::memory_order_relaxed ) + n, std::memory_order_relaxed );
+    } else {
+      value.fetch_add( n, std::memory_order_relaxed );
+    }
+  }
+
+  void set( Stat stat, size_t n )
+  {
+    size_t thread = threadIndex();
+    if( thread < MAX_THREAD_CACHES ) counters_[thread].values[static_cast<size_t>( stat )].store( n, std::memory_order_relaxed );
+  }
+
+  /*
+   * The value of a counter for one thread index,
+   * MAX_THREAD_CACHES standing for the threads beyond
+   * */
+  size_t get( size_t thread, Stat stat ) const
+  {
+    return counters_[thread].values[static_cast<size_t>( stat )].load( std::memory_order_relaxed );
+  }
+
+  size_t total( Stat stat ) const
+  {
+    size_t sum = 0;
+
+    for( size_t thread = 0; thread <= MAX_THREAD_CACHES; ++thread ) {
+      sum += get( thread, stat );
+    }
+
+    return sum;
+  }
+};
+
+/*
+ * What VectorList::stats() reports. The lock counters belong to the
+ * LockPolicy and are shared by every container using it
+ * */
+struct ContainerStats
+{
+  size_t blocks_pushed = 0;
+  size_t refills = 0;
+  size_t flushes = 0;
+  size_t iteration_steps = 0;
+  size_t slots_skipped = 0;
+  size_t relocations = 0;
+
+  // free slots in the shared pool and in each thread's cache
+  size_t pool_free = 0;
+  std::vector<size_t> cached_free;
+
+  size_t lock_contended = 0;
+  size_t lock_spins = 0;
+  size_t lock_yields = 0;
+  size_t lock_waits = 0;
+};
+
+/*
+ * End of namespace
+ * */
+}
+
+#endif // STATSPOLICIES_HPP_
@@ -2,12 +2,62 @@
 
 namespace Utils
 {
+namespace
+{
+std::mutex index_lock;
+std::vector<size_t> released_indices;
+size_t next_index = 0;
+
+/*
+ * Claims an index on a thread's first call to threadIndex()
+ * and gives it back when the thread exits
+ * */
+struct ThreadIndex
+{
+  size_t index;
+
+  ThreadIndex( void )
+  {
+    std::lock_guard<std::mutex> guard( index_lock );
+
+    if( released_indices.empty() ) {
+      index = next_index++;
+    } else {
+      index = released_indices.back();
+      released_indices.pop_back();
+    }
+  }
+
+  ~ThreadIndex( void )
+  {
+    std::lock_guard<std::mutex> guard( index_lock );
+    released_indices.push_back( index );
+  }
+};
+}
+
+size_t threadIndex( void )
+{
+  thread_local ThreadIndex thread_index;
+  return thread_index.index;
+}
+
 void spinLock( std::atomic_flag& lock )
 {
   while( lock.test_and_set( std::memory_order_acquire ) ) {
   }
 }
 
+bool trySpinLock( std::atomic_flag& lock )
+{
+  return !lock.test_and_set( std::memory_order_acquire );
+}
+
+void spinUnlock( std::atomic_flag& lock )
+{
+  lock.clear( std::memory_order_release );
+}
+
 /*
  * Create an array of size N of atomic_flags
  * */
@@ -22,6 +72,97 @@ LockPtr createLockArray( size_t size )
   return locks;
 }
 
+/*
+ * Create a zeroed bitmap with at least size bits, followed
+ * by its summary words
+ * */
+BitmapPtr createBitmap( size_t size )
+{
+  size_t num_words = bitmapWords( size ) + summaryWords( size );
+  BitmapPtr bitmap{ new std::atomic<uint64_t>[num_words] };
+
+  for( size_t i = 0; i < num_words; ++i ) {
+    bitmap[i].store( 0, std::memory_order_relaxed );
+  }
+
+  return bitmap;
+}
+
+/*
+ * Find the first set bit at or after bit in a bitmap of size bits,
+ * using the summary to skip empty words. Returns size if there is none
+ * */
+size_t findNextSet( const std::atomic<uint64_t>* occupancy, const std::atomic<uint64_t>* summary, size_t size, size_t bit )
+{
+  size_t num_words = bitmapWords( size );
+  size_t word = bit / BITMAP_WORD_BITS;
+
+  if( word >= num_words ) return size;
+
+  uint64_t bits = occupancy[word].load( std::memory_order_acquire ) & ( ~uint64_t( 0 ) << ( bit % BITMAP_WORD_BITS ) );
+
+  while( !bits ) {
+    // next word whose summary bit is set, after the current one
+    size_t next = word + 1;
+    size_t summary_word = next / BITMAP_WORD_BITS;
+    size_t num_summary_words = summaryWords( size );
+    uint64_t marks = 0;
+
+    if( summary_word < num_summary_words ) {
+      marks = summary[summary_word].load( std::memory_order_acquire ) & ( ~uint64_t( 0 ) << ( next % BITMAP_WORD_BITS ) );
+
+      while( !marks && ++summary_word < num_summary_words ) {
+        marks = summary[summary_word].load( std::memory_order_acquire );
+      }
+    }
+
+    if( !marks ) return size;
+
+    word = summary_word * BITMAP_WORD_BITS + std::countr_zero( marks );
+    bits = occupancy[word].load( std::memory_order_acquire );
+  }
+
+  return word * BITMAP_WORD_BITS + std::countr_zero( bits );
+}
+
+/*
+ * Find the last set bit before limit, using the summary
+ * to skip empty words. Returns limit if there is none
+ * */
+size_t findPrevSet( const std::atomic<uint64_t>* occupancy, const std::atomic<uint64_t>* summary, size_t limit )
+{
+  if( limit == 0 ) return limit;
+
+  size_t word = ( limit - 1 ) / BITMAP_WORD_BITS;
+  size_t shift = limit % BITMAP_WORD_BITS;
+
+  uint64_t bits = occupancy[word].load( std::memory_order_acquire );
+  if( shift ) bits &= ( uint64_t( 1 ) << shift ) - 1;
+
+  while( !bits ) {
+    // previous word whose summary bit is set, before the current one
+    if( word == 0 ) return limit;
+
+    size_t prev = word - 1;
+    size_t summary_word = prev / BITMAP_WORD_BITS;
+    size_t summary_shift = prev % BITMAP_WORD_BITS + 1;
+
+    uint64_t marks = summary[summary_word].load( std::memory_order_acquire );
+    if( summary_shift < BITMAP_WORD_BITS ) marks &= ( uint64_t( 1 ) << summary_shift ) - 1;
+
+    while( !marks && summary_word > 0 ) {
+      marks = summary[--summary_word].load( std::memory_order_acquire );
+    }
+
+    if( !marks ) return limit;
+
+    word = summary_word * BITMAP_WORD_BITS + ( BITMAP_WORD_BITS - 1 - std::countl_zero( marks ) );
+    bits = occupancy[word].load( std::memory_order_acquire );
+  }
+
+  return word * BITMAP_WORD_BITS + ( BITMAP_WORD_BITS - 1 - std::countl_zero( bits ) );
+}
+
 /*
  * End of namespace
  * */
@@ -3,45 +3,266 @@
 
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <optional>
 
 #include "../globals.hpp"
+#include "./lockpolicies.hpp"
 
 template <class T>
 class Element;
 
+template <class T>
+class Slot;
+
 namespace Utils
 {
 
 LockPtr createLockArray( size_t size );
+BitmapPtr createBitmap( size_t size );
 
 /*
- * Execute functions with a spinlock as the
- * functional mutex
+ * Set and clear single bits of an occupancy bitmap.
+ * Setting releases so a reader that sees the bit through an
+ * acquire load also sees the Element constructed before it
+ * */
+inline void setBit( std::atomic<uint64_t>* bitmap, size_t bit )
+{
+  bitmap[bit / BITMAP_WORD_BITS].fetch_or( uint64_t( 1 ) << ( bit % BITMAP_WORD_BITS ), std::memory_order_release );
+}
+
+inline void clearBit( std::atomic<uint64_t>* bitmap, size_t bit )
+{
+  bitmap[bit / BITMAP_WORD_BITS].fetch_and( ~( uint64_t( 1 ) << ( bit % BITMAP_WORD_BITS ) ), std::memory_order_relaxed );
+}
+
+inline bool testBit( const std::atomic<uint64_t>* bitmap, size_t bit )
+{
+  return bitmap[bit / BITMAP_WORD_BITS].load( std::memory_order_acquire ) & ( uint64_t( 1 ) << ( bit % BITMAP_WORD_BITS ) );
+}
+
+/*
+ * Number of occupancy words for size bits, and the number of
+ * summary words that follow them in a bitmap from createBitmap
+ * */
+inline size_t bitmapWords( size_t size )
+{
+  return ( size + BITMAP_WORD_BITS - 1 ) / BITMAP_WORD_BITS;
+}
+
+inline size_t summaryWords( size_t size )
+{
+  return ( bitmapWords( size ) + BITMAP_WORD_BITS - 1 ) / BITMAP_WORD_BITS;
+}
+
+/*
+ * Set and clear a bit of an occupancy bitmap while keeping its
+ * summary up to date, so scans can jump over any run of empty
+ * words in one step.
+ *
+ * A summary bit is only cleared by the thread that emptied the
+ * word, which then re-checks the word in case another thread
+ * filled it in between. A stale summary bit only costs a scan
+ * one wasted load; a missing one would hide an Alive Element
+ * */
+inline void setOccupied( std::atomic<uint64_t>* occupancy, std::atomic<uint64_t>* summary, size_t bit )
+{
+  setBit( occupancy, bit );
+  setBit( summary, bit / BITMAP_WORD_BITS );
+}
+
+/*
+ * Clear the bits of mask in one occupancy word
+ * */
+inline void clearOccupiedMask( std::atomic<uint64_t>* occupancy, std::atomic<uint64_t>* summary, size_t word, uint64_t mask )
+{
+  if( occupancy[word].fetch_and( ~mask, std::memory_order_acq_rel ) & ~mask ) return;
+
+  uint64_t summary_mask = uint64_t( 1 ) << ( word % BITMAP_WORD_BITS );
+  summary[word / BITMAP_WORD_BITS].fetch_and( ~summary_mask, std::memory_order_acq_rel );
+
+  if( occupancy[word].load( std::memory_order_acquire ) ) {
+    summary[word / BITMAP_WORD_BITS].fetch_or( summary_mask, std::memory_order_acq_rel );
+  }
+}
+
+inline void clearOccupied( std::atomic<uint64_t>* occupancy, std::atomic<uint64_t>* summary, size_t bit )
+{
+  clearOccupiedMask( occupancy, summary, bit / BITMAP_WORD_BITS, uint64_t( 1 ) << ( bit % BITMAP_WORD_BITS ) );
+}
+
+/*
+ * Set count consecutive bits starting at first, one word at a time
  * */
-void spinLock( std::atomic_flag& lock );
+inline void setOccupiedRange( std::atomic<uint64_t>* occupancy, std::atomic<uint64_t>* summary, size_t first, size_t count )
+{
+  size_t end = first + count;
+
+  while( first < end ) {
+    size_t word = first / BITMAP_WORD_BITS;
+    size_t shift = first % BITMAP_WORD_BITS;
+    size_t bits = std::min( end - first, BITMAP_WORD_BITS - shift );
+    uint64_t mask = ( bits == BITMAP_WORD_BITS ? ~uint64_t( 0 ) : ( uint64_t( 1 ) << bits ) - 1 ) << shift;
+
+    occupancy[word].fetch_or( mask, std::memory_order_release );
+    setBit( summary, word );
+    first += bits;
+  }
+}
+
+size_t findNextSet( const std::atomic<uint64_t>* occupancy, const std::atomic<uint64_t>* summary, size_t size, size_t bit );
+size_t findPrevSet( const std::atomic<uint64_t>* occupancy, const std::atomic<uint64_t>* summary, size_t limit );
+
+/*
+ * Pack and unpack the two halves of a SlotId
+ * */
+inline SlotId makeSlotId( size_t block, size_t index )
+{
+  return ( SlotId( block ) << 32 ) | SlotId( index );
+}
+
+inline size_t slotBlock( SlotId slot )
+{
+  return size_t( slot >> 32 );
+}
+
+inline size_t slotIndex( SlotId slot )
+{
+  return size_t( slot & 0xffffffff );
+}
+
+/*
+ * Pack and unpack the fields of a Handle. Only the low
+ * HANDLE_GENERATION_BITS bits of a generation are kept
+ * */
+inline Handle makeHandle( size_t block, size_t index, uint32_t generation )
+{
+  assert( block < ( size_t( 1 ) << HANDLE_BLOCK_BITS ) );
+  assert( index > 0 && index <= ( size_t( 1 ) << HANDLE_INDEX_BITS ) );
+
+  return ( Handle( generation & ( ( 1u << HANDLE_GENERATION_BITS ) - 1 ) ) << ( HANDLE_BLOCK_BITS + HANDLE_INDEX_BITS ) )
+         | ( Handle( block ) << HANDLE_INDEX_BITS ) | Handle( index - 1 );
+}
+
+inline size_t handleBlock( Handle handle )
+{
+  return size_t( ( handle >> HANDLE_INDEX_BITS ) & ( ( uint64_t( 1 ) << HANDLE_BLOCK_BITS ) - 1 ) );
+}
+
+inline size_t handleIndex( Handle handle )
+{
+  return size_t( handle & ( ( uint64_t( 1 ) << HANDLE_INDEX_BITS ) - 1 ) ) + 1;
+}
+
+inline uint32_t handleGeneration( Handle handle )
+{
+  return uint32_t( handle >> ( HANDLE_BLOCK_BITS + HANDLE_INDEX_BITS ) );
+}
+
+/*
+ * Start a new generation of a Slot that is being filled. Only the
+ * thread filling the Slot writes it, readers see the new value
+ * once the occupancy bit is published with release
+ * */
+inline void nextGeneration( std::atomic<uint32_t>& generation )
+{
+  generation.store( generation.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+}
+
+inline bool sameGeneration( uint32_t a, uint32_t b )
+{
+  return ( ( a ^ b ) & ( ( 1u << HANDLE_GENERATION_BITS ) - 1 ) ) == 0;
+}
+
+/*
+ * The newest generation any Slot of a block has reached
+ * */
+template <class T>
+uint32_t maxGeneration( const BlockInfo<T>& info )
+{
+  uint32_t newest = 0;
+
+  for( size_t i = 1; i <= info.size; ++i ) {
+    newest = std::max( newest, info.generations[i].load( std::memory_order_relaxed ) );
+  }
+
+  return newest;
+}
+
+/*
+ * A small integer unique among the running threads.
+ * Indices of exited threads are handed out again
+ * */
+size_t threadIndex( void );
+
+/*
+ * Holds a spinlock for the lifetime of the guard so
+ * the lock is released even if the guarded call throws.
+ * Policy is one of the lock policies in lockpolicies.hpp
+ * */
+template <class Policy = SpinPolicy>
+class SpinLockGuard
+{
+  private:
+  std::atomic_flag& lock_;
+
+  public:
+  explicit SpinLockGuard( std::atomic_flag& lock )
+      : lock_( lock )
+  {
+    Policy::lock( lock_ );
+  }
+
+  // takes over a lock already acquired by the caller
+  SpinLockGuard( std::atomic_flag& lock, std::adopt_lock_t )
+      : lock_( lock )
+  {
+  }
+
+  SpinLockGuard( const SpinLockGuard& other ) = delete;
+  SpinLockGuard& operator=( const SpinLockGuard& other ) = delete;
+
+  ~SpinLockGuard( void )
+  {
+    Policy::unlock( lock_ );
+  }
+};
+
 template <typename T>
 struct Tag
 {
 };
 
-template <typename F>
+/*
+ * What a call that may not run returns: whether it ran for
+ * a void call, the value it returned if it did otherwise
+ * */
+template <class R>
+using MaybeResult = std::conditional_t<std::is_void_v<R>, bool, std::optional<R> >;
+
+template <typename Policy, typename F>
 auto spinLockExecutorHelper( const F& f, std::atomic_flag& lock, Tag<void> ) -> void
 {
-  spinLock( lock );
+  SpinLockGuard<Policy> guard( lock );
   f();
 }
 
-template <typename F, typename R>
+template <typename Policy, typename F, typename R>
 auto spinLockExecutorHelper( const F& f, std::atomic_flag& lock, Tag<R> ) -> R
 {
-  spinLock( lock );
+  SpinLockGuard<Policy> guard( lock );
   return f();
 }
 
-template <class F>
+/*
+ * Execute functions with a spinlock as the
+ * functional mutex. How waiting threads spin is
+ * chosen by the Policy
+ * */
+template <class Policy = SpinPolicy, class F>
 auto spinLockExecutor( const F& f, std::atomic_flag& l ) -> decltype( f() )
 {
-  return spinLockExecutorHelper( f, l, Tag<decltype( f() )>{} );
+  return spinLockExecutorHelper<Policy>( f, l, Tag<decltype( f() )>{} );
 }
 
 /*
@@ -57,6 +278,19 @@ void setInternalFreeList( Element<T>* elements, size_t size )
   }
 }
 
+/*
+ * Same as setInternalFreeList() but for Slots, which link by
+ * SlotId. slots[0] is given index first_index within block and
+ * the last one links to tail
+ * */
+template <class T>
+void setInternalSlotList( Slot<T>* slots, size_t size, size_t block, size_t first_index, SlotId tail )
+{
+  for( size_t i = 0; i < size; ++i ) {
+    slots[i].setNextSlot( i == size - 1 ? tail : makeSlotId( block, first_index + i + 1 ) );
+  }
+}
+
 /*
  * Takes an array of Elements of size N and sets the first
  * and last Elements to be of state Boundary
@@ -85,10 +319,112 @@ Block<T> createBlock( size_t size )
   setInternalFreeList( block_ptr.get() + 1, size );
   markBoundaries( block_ptr.get(), num_elements );
 
-  Block<T> block( std::move( block_ptr ), std::move( createLockArray( num_elements ) ), size );
+  Block<T> block( std::move( block_ptr ), std::move( createLockArray( num_elements ) ), std::move( createBitmap( size ) ), size );
   return block;
 }
 
+/*
+ * Allocate an array of size value-initialised Us from allocator.
+ * Trivial types such as Slot are left uninitialised, as with new[]
+ * */
+template <class U, class Allocator>
+ArrayPtr<U, Allocator> allocateArray( const Allocator& allocator, size_t size )
+{
+  static_assert( std::is_nothrow_default_constructible_v<U> );
+
+  typedef ArrayDeleter<U, Allocator> Deleter;
+  typename Deleter::allocator_type rebound( allocator );
+  U* array = Deleter::traits::allocate( rebound, size );
+
+  if constexpr( !std::is_trivially_default_constructible_v<U> ) {
+    for( size_t i = 0; i < size; ++i ) {
+      Deleter::traits::construct( rebound, array + i );
+    }
+  }
+
+  return ArrayPtr<U, Allocator>( array, Deleter{ rebound, size } );
+}
+
+/*
+ * Allocate the arrays of a block of capacity N without
+ * initialising its Slots, for callers that fill them in
+ * */
+template <class T, class Allocator>
+SlotBlock<T, Allocator> allocateSlotBlock( size_t size, const Allocator& allocator )
+{
+  return SlotBlock<T, Allocator>( allocateArray<Slot<T> >( allocator, size + 2 ), allocateArray<std::atomic_flag>( allocator, size + 2 ),
+                                  allocateArray<std::atomic<uint64_t> >( allocator, bitmapWords( size ) + summaryWords( size ) + 1 ),
+                                  allocateArray<std::atomic<uint32_t> >( allocator, size + 2 ), size );
+}
+
+/*
+ * A block that owns no arrays, standing in for a trimmed one
+ * */
+template <class T, class Allocator>
+SlotBlock<T, Allocator> emptySlotBlock( const Allocator& allocator )
+{
+  return SlotBlock<T, Allocator>( SlotPtr<T, Allocator>( nullptr, { allocator, 0 } ),
+                                  LockArray<Allocator>( nullptr, { allocator, 0 } ),
+                                  BitmapArray<Allocator>( nullptr, { allocator, 0 } ),
+                                  GenerationArray<Allocator>( nullptr, { allocator, 0 } ), 0 );
+}
+
+/*
+ * The view of a block kept in the block table
+ * */
+template <class T, class Allocator>
+BlockInfo<T> makeBlockInfo( SlotBlock<T, Allocator>& block )
+{
+  size_t size = std::get<size_t>( block );
+  std::atomic<uint64_t>* bitmap = std::get<BitmapArray<Allocator> >( block ).get();
+
+  return BlockInfo<T>{ std::get<SlotPtr<T, Allocator> >( block ).get(), std::get<LockArray<Allocator> >( block ).get(), bitmap,
+                       bitmap + bitmapWords( size ), bitmap + bitmapWords( size ) + summaryWords( size ),
+                       std::get<GenerationArray<Allocator> >( block ).get(), size, 0, 0, 0, 0 };
+}
+
+/*
+ * Construct len values into consecutive Free Slots, calling
+ * construct( slot ) for each. If a constructor throws, the
+ * values already built are destroyed before rethrowing
+ * */
+template <class T, class F>
+void constructSlots( Slot<T>* slots, size_t len, F&& construct )
+{
+  size_t i = 0;
+
+  try {
+    for( ; i < len; ++i ) {
+      construct( slots[i] );
+    }
+  } catch( ... ) {
+    while( i > 0 ) {
+      slots[--i].destroy();
+    }
+    throw;
+  }
+}
+
+/*
+ * Clear the Boundaries and the bitmap of a block so it can be
+ * pushed. Its inner Slots are left alone, a container links them
+ * into its free lists only as they are handed out
+ * */
+template <class T, class Allocator>
+void resetSlotBlock( SlotBlock<T, Allocator>& slot_block )
+{
+  size_t size = std::get<size_t>( slot_block );
+  Slot<T>* slots = std::get<SlotPtr<T, Allocator> >( slot_block ).get();
+  auto& bitmap = std::get<BitmapArray<Allocator> >( slot_block );
+
+  slots[0].setNext( nullptr );
+  slots[size + 1].setNext( nullptr );
+
+  for( size_t i = 0; i < bitmap.get_deleter().size; ++i ) {
+    bitmap[i].store( 0, std::memory_order_relaxed );
+  }
+}
+
 /*
  * Link two elements together
  * */
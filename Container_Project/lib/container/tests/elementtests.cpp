@@ -39,6 +39,34 @@ template <> void elementTests<int>( void )
     assert( other_element.getState() == ElementState::Free );
     assert( other_element.getNext() == &element );
   }
+
+  /*
+   * Copies and moves should carry the state along with the
+   * value, and assignments should return the assigned Element
+   * */
+  {
+    Element<int> element;
+    element.emplace( 7 );
+
+    Element<int> copy( element );
+    assert( copy.getState() == ElementState::Alive );
+    assert( copy.getData() == 7 );
+
+    Element<int> moved( std::move( copy ) );
+    assert( moved.getData() == 7 );
+    assert( copy.getState() == ElementState::Free );
+
+    Element<int> assigned;
+    assert( ( assigned = element ).getData() == 7 );
+    assert( ( copy = std::move( assigned ) ).getData() == 7 );
+    assert( assigned.getState() == ElementState::Free );
+
+    Element<int> free_element;
+    free_element.setNext( &element );
+    copy = free_element;
+    assert( copy.getState() == ElementState::Free );
+    assert( copy.getNext() == &element );
+  }
 }
 
 /*
@@ -81,6 +109,7 @@ template <> void elementTests<NonTrivial>( void )
     element.emplace(); // +1 allocation = 3
 
     Element<NonTrivial> other( (const Element<NonTrivial>&)element ); // +1 allocation = 4
+    assert( other.getDataByReference().data_ != element.getDataByReference().data_ );
   }
 
   /*
@@ -91,6 +120,7 @@ template <> void elementTests<NonTrivial>( void )
     element.emplace(); // +1 allocation = 5
 
     Element<NonTrivial> other = std::move( element );
+    assert( element.getState() == ElementState::Free );
   }
 
   /*
@@ -103,8 +133,24 @@ template <> void elementTests<NonTrivial>( void )
     Element<NonTrivial> other = element; // +1 allocation = 7
   }
 
+  /*
+   * Assigning over an Alive Element should reuse it and
+   * assigning over a Free one should construct into it
+   * */
+  {
+    Element<NonTrivial> element;
+    element.emplace(); // +1 allocation = 8
+
+    Element<NonTrivial> other;
+    other = element; // +1 allocation = 9
+    other = element; // +1 allocation = 10, -1 free
+    other = std::move( element ); // -1 free
+    assert( element.getState() == ElementState::Free );
+    assert( other.getState() == ElementState::Alive );
+  }
+
   /*
    * Ensure with memory tracker that there are
-   * 7 allocations and 7 frees
+   * 10 allocations and 10 frees
    * */
 }
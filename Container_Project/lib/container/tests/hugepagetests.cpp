@@ -0,0 +1,118 @@
+#include "./test.hpp"
+#include "../helpers/hugepages.hpp"
+#include "../vectorlist/vectorlist.hpp"
+
+void hugePageTests( void )
+{
+  auto aligned = []( void* p ) -> bool { return reinterpret_cast<uintptr_t>( p ) % HUGE_PAGE_SIZE == 0; };
+
+  /*
+   * Large allocations should start on huge page boundaries and be
+   * counted in whole huge pages, small ones should go upstream
+   * */
+  {
+    Utils::HugePageResource resource;
+
+    void* large = resource.allocate( HUGE_PAGE_SIZE + 1 );
+    assert( aligned( large ) );
+    assert( resource.inUse() == 2 * HUGE_PAGE_SIZE );
+    assert( resource.mapped() == HUGE_REGION_SIZE );
+
+    void* small = resource.allocate( 64 );
+    assert( resource.inUse() == 2 * HUGE_PAGE_SIZE );
+
+    std::memset( large, 1, HUGE_PAGE_SIZE + 1 );
+
+    resource.deallocate( small, 64 );
+    resource.deallocate( large, HUGE_PAGE_SIZE + 1 );
+    assert( resource.inUse() == 0 );
+  }
+
+  /*
+   * A freed extent should be handed out again with its pages
+   * dropped, and freed neighbours should merge
+   * */
+  {
+    Utils::HugePageResource resource;
+
+    char* a = static_cast<char*>( resource.allocate( HUGE_PAGE_SIZE ) );
+    char* b = static_cast<char*>( resource.allocate( HUGE_PAGE_SIZE ) );
+    assert( b == a + HUGE_PAGE_SIZE );
+
+    a[0] = 42;
+    resource.deallocate( a, HUGE_PAGE_SIZE );
+
+    char* again = static_cast<char*>( resource.allocate( HUGE_PAGE_SIZE ) );
+    assert( again == a );
+    assert( again[0] == 0 );
+
+    resource.deallocate( again, HUGE_PAGE_SIZE );
+    resource.deallocate( b, HUGE_PAGE_SIZE );
+
+    char* both = static_cast<char*>( resource.allocate( 2 * HUGE_PAGE_SIZE ) );
+    assert( both == a );
+    assert( resource.mapped() == HUGE_REGION_SIZE );
+    resource.deallocate( both, 2 * HUGE_PAGE_SIZE );
+  }
+
+  /*
+   * Allocations larger than a region should get a region of their own
+   * */
+  {
+    Utils::HugePageResource resource( HUGE_PAGE_SIZE, HUGE_PAGE_SIZE );
+
+    void* first = resource.allocate( HUGE_PAGE_SIZE );
+    void* second = resource.allocate( 3 * HUGE_PAGE_SIZE );
+
+    assert( aligned( first ) && aligned( second ) );
+    assert( resource.mapped() == 4 * HUGE_PAGE_SIZE );
+
+    resource.deallocate( first, HUGE_PAGE_SIZE );
+    resource.deallocate( second, 3 * HUGE_PAGE_SIZE );
+  }
+
+  /*
+   * A huge page growth policy should fill whole huge pages
+   * */
+  {
+    const size_t slot_size = sizeof( Slot<int> );
+
+    size_t size = Utils::HugePageGrowth<>::initial( slot_size );
+    assert( ( size + 2 ) * slot_size == HUGE_PAGE_SIZE );
+    size = Utils::HugePageGrowth<>::next( size, slot_size );
+    assert( ( size + 2 ) * slot_size == 2 * HUGE_PAGE_SIZE );
+  }
+
+  /*
+   * A container on huge pages should keep its slots in them and
+   * give them back once its blocks are trimmed
+   * */
+  {
+    Utils::HugePageResource resource;
+
+    {
+      pmr::VectorList<int, Utils::BackoffPolicy, Utils::HugePageGrowth<> > vector_list( &resource );
+
+      for( int i = 0; i < 1000000; ++i ) {
+        vector_list.emplace( i );
+      }
+
+      int64_t sum = 0;
+      for( auto segment : vector_list.segments() ) {
+        assert( aligned( segment.data() ) );
+        segment.forEach( [&]( int& value ) -> void { sum += value; } );
+      }
+      assert( sum == int64_t( 999999 ) * 1000000 / 2 );
+
+      size_t in_use = resource.inUse();
+      assert( in_use > 0 );
+
+      vector_list.eraseIf( []( int value ) -> bool { return value >= 1000; } );
+      assert( vector_list.shrinkToFit() > 0 );
+      assert( resource.inUse() < in_use );
+      assert( vector_list.size() == 1000 );
+    }
+
+    assert( resource.inUse() == 0 );
+  }
+}
@@ -0,0 +1,79 @@
+#include "../globals.hpp"
+#include "test.hpp"
+#include "../helpers/utils.hpp"
+
+/*
+ * Hammer a small lock array with every thread through
+ * spinLockExecutor<Policy> and report the contention
+ * counters so the policies can be compared
+ * */
+template <class Policy>
+void lockPolicyTest( const std::string& name )
+{
+  const int size = 8;
+  std::unique_ptr<int[]> p( new int[size] );
+  LockPtr locks{ std::move( Utils::createLockArray( size ) ) };
+
+  for( int i = 0; i < size; ++i ) {
+    p[i] = 0;
+  }
+
+  Policy::stats().reset();
+
+  const int num_threads = 4;
+  std::vector<std::thread> threads;
+  threads.reserve( num_threads );
+
+  const int num_trials = 100000;
+
+  for( int i = 0; i < num_threads; ++i ) {
+    threads.emplace_back( [=, &locks, &p](void) -> void {
+      std::random_device rd;
+      std::mt19937 gen{ rd() };
+      std::uniform_int_distribution<> range{ 0, size - 1 };
+
+      for( int j = 0; j < num_trials; ++j ) {
+        int tmp = range( gen );
+        Utils::spinLockExecutor<Policy>( [&](void) -> void { ++p[tmp]; }, locks[tmp] );
+      }
+    } );
+  }
+
+  for( auto& t : threads )
+    t.join();
+
+  int sum = 0;
+
+  for( int i = 0; i < size; ++i ) {
+    sum += p[i];
+    assert( !locks[i].test() );
+  }
+
+  assert( sum == num_threads * num_trials );
+
+  Utils::LockStats& stats = Policy::stats();
+
+  std::cout << name << " contended : " << stats.contended << " spins : " << stats.spins
+            << " yields : " << stats.yields << " waits : " << stats.waits << std::endl;
+}
+
+void lockPolicyTests( void )
+{
+  lockPolicyTest<Utils::SpinPolicy>( "SpinPolicy" );
+  lockPolicyTest<Utils::YieldPolicy>( "YieldPolicy" );
+  lockPolicyTest<Utils::BackoffPolicy>( "BackoffPolicy" );
+  lockPolicyTest<Utils::WaitPolicy>( "WaitPolicy" );
+
+  /*
+   * tryLock() should fail on a held lock regardless of policy
+   * */
+  {
+    std::atomic_flag lock = ATOMIC_FLAG_INIT;
+
+    Utils::SpinLockGuard<Utils::WaitPolicy> guard( lock );
+    assert( !Utils::SpinPolicy::tryLock( lock ) );
+    assert( !Utils::YieldPolicy::tryLock( lock ) );
+    assert( !Utils::BackoffPolicy::tryLock( lock ) );
+    assert( !Utils::WaitPolicy::tryLock( lock ) );
+  }
+}
@@ -0,0 +1,73 @@
+#include "./test.hpp"
+
+#include <cstring>
+
+/*
+ * Runs the test suites named on the command line,
+ * or every suite if none is named
+ * */
+namespace
+{
+struct Suite
+{
+  const char* name;
+  void ( *run )( void );
+};
+
+const Suite suites[] = {
+  { "utils", utilsTests<int> },
+  { "element", []( void ) -> void {
+     elementTests<int>();
+     elementTests<NonTrivial>();
+   } },
+  { "atomicArray", atomicArrayTests },
+  { "atomicStructArray", atomicStructArrayTests },
+  { "lockPolicy", lockPolicyTests },
+  { "hugePage", hugePageTests },
+  { "vectorListConstructor", vectorListConstructorTests<int> },
+  { "vectorListEmplace", vectorListEmplaceTests<int> },
+  { "vectorListIterator", vectorListIteratorTests<int> },
+  { "vectorListLock", vectorListLockTests<int> },
+  { "vectorListGrowth", vectorListGrowthTests<int> },
+  { "vectorListTrim", vectorListTrimTests<int> },
+  { "vectorListBulk", vectorListBulkTests<int> },
+  { "vectorListParallel", vectorListParallelTests<int> },
+  { "vectorListHandle", vectorListHandleTests<int> },
+  { "vectorListStats", vectorListStatsTests<int> },
+  { "vectorListNode", vectorListNodeTests<int> },
+  { "vectorListPersistence", vectorListPersistenceTests<int> },
+  { "vectorListSnapshot", vectorListSnapshotTests<int> },
+  { "vectorListCompact", vectorListCompactTests<int> },
+};
+}
+
+int main( int argc, char** argv )
+{
+  for( const Suite& suite : suites ) {
+    bool selected = argc == 1;
+
+    for( int i = 1; i < argc; ++i ) {
+      selected |= std::strcmp( argv[i], suite.name ) == 0;
+    }
+
+    if( !selected ) continue;
+
+    std::cout << "Running " << suite.name << " tests" << std::endl;
+    suite.run();
+  }
+
+  for( int i = 1; i < argc; ++i ) {
+    bool known = false;
+
+    for( const Suite& suite : suites ) {
+      known |= std::strcmp( argv[i], suite.name ) == 0;
+    }
+
+    if( !known ) {
+      std::cerr << "Unknown test suite " << argv[i] << std::endl;
+      return 1;
+    }
+  }
+
+  return 0;
+}
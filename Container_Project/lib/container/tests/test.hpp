@@ -14,7 +14,7 @@ class NonTrivial
 
   NonTrivial( void )
   {
-    data_ = new int[16];
+    data_ = new int[16]();
   }
 
   NonTrivial( const NonTrivial& other )
@@ -38,16 +38,19 @@ class NonTrivial
 
   NonTrivial& operator=( const NonTrivial& other )
   {
-    data_ = new int[16];
+    int* data = new int[16];
 
     for( size_t i = 0; i < 16; ++i )
-      data_[i] = other.data_[i];
+      data[i] = other.data_[i];
 
+    delete[] data_;
+    data_ = data;
     return *this;
   }
 
   NonTrivial& operator=( NonTrivial&& other )
   {
+    delete[] data_;
     data_ = other.data_;
     other.data_ = nullptr;
     return *this;
@@ -67,6 +70,71 @@ void vectorListConstructorTests( void );
 template <>
 void vectorListConstructorTests<int>( void );
 
+template <class U>
+void vectorListEmplaceTests( void );
+template <>
+void vectorListEmplaceTests<int>( void );
+
+template <class U>
+void vectorListIteratorTests( void );
+template <>
+void vectorListIteratorTests<int>( void );
+
+template <class U>
+void vectorListLockTests( void );
+template <>
+void vectorListLockTests<int>( void );
+
+template <class U>
+void vectorListGrowthTests( void );
+template <>
+void vectorListGrowthTests<int>( void );
+
+template <class U>
+void vectorListTrimTests( void );
+template <>
+void vectorListTrimTests<int>( void );
+
+template <class U>
+void vectorListBulkTests( void );
+template <>
+void vectorListBulkTests<int>( void );
+
+template <class U>
+void vectorListParallelTests( void );
+template <>
+void vectorListParallelTests<int>( void );
+
+template <class U>
+void vectorListHandleTests( void );
+template <>
+void vectorListHandleTests<int>( void );
+
+template <class U>
+void vectorListStatsTests( void );
+template <>
+void vectorListStatsTests<int>( void );
+
+template <class U>
+void vectorListNodeTests( void );
+template <>
+void vectorListNodeTests<int>( void );
+
+template <class U>
+void vectorListPersistenceTests( void );
+template <>
+void vectorListPersistenceTests<int>( void );
+
+template <class U>
+void vectorListSnapshotTests( void );
+template <>
+void vectorListSnapshotTests<int>( void );
+
+template <class U>
+void vectorListCompactTests( void );
+template <>
+void vectorListCompactTests<int>( void );
+
 template <class U>
 void elementTests( void );
 template <>
@@ -76,5 +144,7 @@ void elementTests<NonTrivial>( void );
 
 void atomicArrayTests( void );
 void atomicStructArrayTests( void );
+void lockPolicyTests( void );
+void hugePageTests( void );
 
 #endif // TEST_HPP_
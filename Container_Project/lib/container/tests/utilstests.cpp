@@ -61,4 +61,38 @@ template <> void utilsTests<int>( void )
     assert( block_ptr[num_elements].getState() == ElementState::Free );
     assert( block_ptr[num_elements].getNext() == nullptr );
   }
+
+  /*
+   * The occupancy scans should find the nearest set bit on either
+   * side through the summary, whatever the gap, and clearing the
+   * last bit of a word should clear its summary bit
+   * */
+  {
+    const size_t size = BITMAP_WORD_BITS * BITMAP_WORD_BITS * 2 + 5;
+    BitmapPtr bitmap = Utils::createBitmap( size );
+    std::atomic<uint64_t>* occupancy = bitmap.get();
+    std::atomic<uint64_t>* summary = occupancy + Utils::bitmapWords( size );
+
+    assert( Utils::findNextSet( occupancy, summary, size, 0 ) == size );
+    assert( Utils::findPrevSet( occupancy, summary, size ) == size );
+
+    const size_t set[] = { 3, 64, 4095, 4096, 8000, size - 1 };
+    for( size_t bit : set ) {
+      Utils::setOccupied( occupancy, summary, bit );
+    }
+
+    for( size_t i = 0; i < sizeof( set ) / sizeof( set[0] ); ++i ) {
+      size_t from = i == 0 ? 0 : set[i - 1] + 1;
+      assert( Utils::findNextSet( occupancy, summary, size, from ) == set[i] );
+      assert( Utils::findPrevSet( occupancy, summary, set[i] + 1 ) == set[i] );
+      if( i > 0 ) assert( Utils::findPrevSet( occupancy, summary, set[i] ) == set[i - 1] );
+    }
+    assert( Utils::findNextSet( occupancy, summary, size, size ) == size );
+    assert( Utils::findPrevSet( occupancy, summary, 3 ) == 3 );
+
+    Utils::clearOccupied( occupancy, summary, 4095 );
+    assert( !Utils::testBit( summary, 4095 / BITMAP_WORD_BITS ) );
+    assert( Utils::findNextSet( occupancy, summary, size, 65 ) == 4096 );
+    assert( Utils::findPrevSet( occupancy, summary, 4096 ) == 64 );
+  }
 }
@@ -0,0 +1,258 @@
+#include "./test.hpp"
+#include "../vectorlist/vectorlist.hpp"
+
+#include <list>
+#include <sstream>
+
+namespace
+{
+/*
+ * Copying one of these throws once the budget runs out
+ * */
+struct Fragile
+{
+  static int budget;
+  static int alive;
+  int value;
+
+  Fragile( int v )
+      : value( v )
+  {
+    ++alive;
+  }
+
+  Fragile( const Fragile& other )
+      : value( other.value )
+  {
+    if( budget-- == 0 ) throw std::runtime_error( "copy failed" );
+    ++alive;
+  }
+
+  ~Fragile( void )
+  {
+    --alive;
+  }
+};
+
+int Fragile::budget = 1 << 30;
+int Fragile::alive = 0;
+}
+
+template <> void vectorListBulkTests<int>( void )
+{
+  /*
+   * A range should be inserted with a single growth and
+   * every value should be present afterwards
+   * */
+  {
+    VectorList<int> vector_list;
+    std::vector<int> values( 100000 );
+
+    for( size_t i = 0; i < values.size(); ++i ) {
+      values[i] = static_cast<int>( i );
+    }
+
+    vector_list.insert( values.begin(), values.end() );
+    assert( vector_list.size() == values.size() );
+    assert( vector_list.table_.size() == 2 );
+
+    std::vector<int> seen;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      seen.push_back( *it );
+    }
+    std::sort( seen.begin(), seen.end() );
+    assert( seen == values );
+  }
+
+  /*
+   * Non-contiguous and single-pass ranges and repeated
+   * values should be inserted too, reusing Free slots
+   * */
+  {
+    VectorList<int> vector_list;
+
+    for( int i = 0; i < 10; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    std::list<int> list{ 10, 11, 12 };
+    vector_list.insert( list.begin(), list.end() );
+
+    std::istringstream stream( "13 14 15" );
+    vector_list.insert( std::istream_iterator<int>( stream ), std::istream_iterator<int>() );
+
+    vector_list.insert( 5, 42 );
+    assert( vector_list.size() == 21 );
+    assert( vector_list.capacity() == INITIAL_BLOCK_SIZE + 5 );
+
+    int sum = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      sum += *it;
+    }
+    assert( sum == 15 * 16 / 2 + 5 * 42 );
+  }
+
+  /*
+   * eraseIf() should remove exactly the matching elements and
+   * the freed slots should be reused without growing
+   * */
+  {
+    VectorList<int> vector_list;
+    const int size = 10000;
+
+    vector_list.insert( size, 0 );
+    int i = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      *it = i++;
+    }
+
+    assert( vector_list.eraseIf( []( int value ) -> bool { return value % 2 == 0; } ) == size / 2 );
+    assert( vector_list.size() == size / 2 );
+
+    size_t count = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      assert( *it % 2 == 1 );
+      ++count;
+    }
+    assert( count == size / 2 );
+
+    size_t capacity = vector_list.capacity();
+    vector_list.insert( size / 2, -1 );
+    assert( vector_list.capacity() == capacity );
+    assert( vector_list.size() == size );
+  }
+
+  /*
+   * A throwing predicate should leave no element locked and
+   * give the slots erased before it back to the pool
+   * */
+  {
+    VectorList<int> vector_list;
+    const int size = 10000;
+
+    vector_list.insert( size, 0 );
+    int i = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      *it = i++;
+    }
+
+    bool thrown = false;
+
+    try {
+      vector_list.eraseIf( []( int value ) -> bool {
+        if( value == size / 2 + 1 ) throw std::runtime_error( "pred failed" );
+        return value % 2 == 0;
+      } );
+    } catch( const std::runtime_error& ) {
+      thrown = true;
+    }
+    assert( thrown );
+    assert( vector_list.size() < size && vector_list.size() > size / 2 );
+
+    size_t count = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      assert( vector_list.tryUpdate( it, []( int& ) -> void {} ) );
+      ++count;
+    }
+    assert( count == vector_list.size() );
+
+    size_t capacity = vector_list.capacity();
+    vector_list.insert( capacity - vector_list.size(), -1 );
+    assert( vector_list.capacity() == capacity );
+  }
+
+  /*
+   * erase() should remove a sub-range spanning several blocks
+   * and leave everything outside of it in place
+   * */
+  {
+    VectorList<int> vector_list;
+
+    for( int i = 0; i < 1000; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    auto first = vector_list.begin();
+    auto last = vector_list.begin();
+    for( int i = 0; i < 100; ++i ) {
+      ++first;
+    }
+    for( int i = 0; i < 900; ++i ) {
+      ++last;
+    }
+
+    assert( vector_list.erase( first, last ) == 800 );
+    assert( vector_list.size() == 200 );
+
+    int i = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it, ++i ) {
+      assert( *it == ( i < 100 ? i : i + 800 ) );
+    }
+
+    assert( vector_list.erase( vector_list.begin(), vector_list.end() ) == 200 );
+    assert( vector_list.size() == 0 );
+    assert( vector_list.begin() == vector_list.end() );
+  }
+
+  /*
+   * A throwing copy should leave no partly built run behind
+   * and give every slot it did not fill back
+   * */
+  {
+    VectorList<Fragile> vector_list;
+    std::vector<Fragile> values;
+
+    values.reserve( 100 );
+    for( int i = 0; i < 100; ++i ) {
+      values.emplace_back( i );
+    }
+
+    Fragile::budget = 40;
+    bool thrown = false;
+
+    try {
+      vector_list.insert( values.begin(), values.end() );
+    } catch( const std::runtime_error& ) {
+      thrown = true;
+    }
+
+    assert( thrown );
+    assert( vector_list.size() <= 40 );
+    assert( Fragile::alive == 100 + static_cast<int>( vector_list.size() ) );
+
+    Fragile::budget = 1000;
+    size_t capacity = vector_list.capacity();
+    vector_list.insert( 100 - vector_list.size(), Fragile( 0 ) );
+    assert( vector_list.size() == 100 );
+    assert( vector_list.capacity() == capacity );
+  }
+  assert( Fragile::alive == 0 );
+
+  /*
+   * eraseIf() should be safe against other threads
+   * updating elements through their locks
+   * */
+  {
+    VectorList<int> vector_list;
+    const int size = 20000;
+
+    vector_list.insert( size, 1 );
+
+    std::thread writer( [&]() -> void {
+      for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+        vector_list.tryUpdate( it, []( int& value ) -> void { value = 2; } );
+      }
+    } );
+
+    size_t erased = vector_list.eraseIf( []( int value ) -> bool { return value == 1; } );
+    writer.join();
+
+    size_t twos = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      assert( *it == 2 );
+      ++twos;
+    }
+    assert( erased + twos == size );
+    assert( vector_list.size() == twos );
+  }
+}
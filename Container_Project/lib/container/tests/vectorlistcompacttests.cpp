@@ -0,0 +1,159 @@
+#include <unordered_map>
+
+#include "./test.hpp"
+#include "../vectorlist/vectorlist.hpp"
+
+template <> void vectorListCompactTests<int>( void )
+{
+  auto sumOf = []( VectorList<int>& vector_list ) -> int64_t {
+    int64_t sum = 0;
+    for( auto segment : vector_list.segments() ) {
+      segment.forEach( [&]( int& value ) -> void { sum += value; } );
+    }
+    return sum;
+  };
+
+  /*
+   * Compacting a thinned out container a little at a time should move
+   * no more than the budget per call, report every move, keep every
+   * value and end up needing far fewer blocks
+   * */
+  {
+    VectorList<int> vector_list;
+    std::unordered_map<int, Handle> handles;
+
+    for( int i = 0; i < 100000; ++i ) {
+      Handle handle = vector_list.emplaceHandle( i );
+      if( i % 10 == 0 ) handles[i] = handle;
+    }
+    vector_list.eraseIf( []( int value ) -> bool { return value % 10 != 0; } );
+
+    size_t size = vector_list.size();
+    int64_t sum = sumOf( vector_list );
+    size_t capacity = vector_list.capacity();
+
+    std::unordered_map<Handle, Handle> moves;
+    size_t moved;
+
+    do {
+      moved = vector_list.compact( 1000, [&]( Handle from, Handle to ) -> void {
+        assert( !moves.count( from ) );
+        moves[from] = to;
+      } );
+      assert( moved <= 1000 );
+
+      // handles are followed to where their elements went
+      for( auto& [value, handle] : handles ) {
+        auto move = moves.find( handle );
+        if( move != moves.end() ) handle = move->second;
+      }
+      moves.clear();
+
+      assert( vector_list.size() == size );
+    } while( moved );
+
+    assert( sumOf( vector_list ) == sum );
+    assert( vector_list.capacity() < capacity / 4 );
+
+    for( auto& [value, handle] : handles ) {
+      int* found = vector_list.get( handle );
+      assert( found && *found == value );
+    }
+
+    size_t count = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      ++count;
+    }
+    assert( count == size );
+
+    // the holes left over are still free to use
+    capacity = vector_list.capacity();
+    while( vector_list.size() < capacity ) {
+      vector_list.emplace( 0 );
+    }
+    assert( vector_list.capacity() == capacity );
+    assert( sumOf( vector_list ) == sum );
+  }
+
+  /*
+   * A container without holes worth filling should be left alone
+   * */
+  {
+    VectorList<int> vector_list;
+
+    for( int i = 0; i < 10000; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    assert( vector_list.compact( 1000 ) == 0 );
+    assert( vector_list.size() == 10000 );
+    assert( sumOf( vector_list ) == int64_t( 9999 ) * 10000 / 2 );
+  }
+
+  /*
+   * A call should only drop the blocks it empties itself, leaving
+   * blocks that were empty already to trim()
+   * */
+  {
+    VectorList<int> vector_list;
+
+    for( int i = 0; i < 20000; ++i ) {
+      vector_list.emplace( i );
+    }
+    // the first block ends up empty and the second holds a single element
+    vector_list.eraseIf( []( int value ) -> bool { return value < 3 * INITIAL_BLOCK_SIZE ? value != INITIAL_BLOCK_SIZE : value % 2 != 0; } );
+
+    size_t num_blocks = vector_list.table_.size();
+    size_t size = vector_list.size();
+    int64_t sum = sumOf( vector_list );
+
+    assert( vector_list.compact( 100 ) > 0 );
+    assert( vector_list.table_.size() == num_blocks - 1 );
+    assert( vector_list.table_[0].size == INITIAL_BLOCK_SIZE && vector_list.table_[0].live->load() == 0 );
+    assert( vector_list.size() == size && sumOf( vector_list ) == sum );
+
+    size_t count = 0;
+    for( auto it = vector_list.rend(); it != vector_list.rbegin(); --it ) {
+      ++count;
+    }
+    assert( count == size );
+
+    assert( vector_list.trim() >= 1 );
+    assert( vector_list.table_[0].live->load() > 0 );
+  }
+
+  /*
+   * Elements that own memory should be moved, not copied, and moves
+   * should be counted
+   * */
+  {
+    VectorList<NonTrivial, Utils::BackoffPolicy, Utils::LinearGrowth<>, std::allocator<NonTrivial>, Utils::CountingStats> vector_list;
+    std::vector<Handle> handles;
+    std::vector<int*> data;
+
+    for( int i = 0; i < 5000; ++i ) {
+      Handle handle = vector_list.emplaceHandle();
+      if( i % 7 == 0 ) {
+        NonTrivial* value = vector_list.get( handle );
+        value->data_[0] = i;
+        handles.push_back( handle );
+        data.push_back( value->data_ );
+      }
+    }
+    vector_list.eraseIf( []( const NonTrivial& value ) -> bool { return value.data_[0] == 0; } );
+    assert( vector_list.size() == handles.size() - 1 );
+
+    size_t moved = vector_list.compact( SIZE_MAX, [&]( Handle from, Handle to ) -> void {
+      for( Handle& handle : handles ) {
+        if( handle == from ) handle = to;
+      }
+    } );
+    assert( moved > 0 );
+    assert( vector_list.stats().relocations == moved );
+
+    for( size_t i = 1; i < handles.size(); ++i ) {
+      NonTrivial* value = vector_list.get( handles[i] );
+      assert( value && value->data_ == data[i] && value->data_[0] == int( i * 7 ) );
+    }
+  }
+}
@@ -1,6 +1,39 @@
 #include "./test.hpp"
 #include "../vectorlist/vectorlist.hpp"
 
+namespace
+{
+/*
+ * Memory resource that counts what goes through it
+ * */
+class CountingResource : public std::pmr::memory_resource
+{
+  public:
+  size_t allocations = 0;
+  size_t bytes = 0;
+
+  private:
+  void* do_allocate( size_t size, size_t alignment ) override
+  {
+    ++allocations;
+    bytes += size;
+    return std::pmr::new_delete_resource()->allocate( size, alignment );
+  }
+
+  void do_deallocate( void* p, size_t size, size_t alignment ) override
+  {
+    --allocations;
+    bytes -= size;
+    std::pmr::new_delete_resource()->deallocate( p, size, alignment );
+  }
+
+  bool do_is_equal( const std::pmr::memory_resource& other ) const noexcept override
+  {
+    return this == &other;
+  }
+};
+}
+
 template <> void vectorListConstructorTests<int>(void)
 {
   /*
@@ -11,4 +44,165 @@ template <> void vectorListConstructorTests<int>(void)
     assert(vector_list.capacity() == INITIAL_BLOCK_SIZE);
     assert(vector_list.size() == 0);
   }
+
+  /*
+   * Slots should only be as large as their payload, with the
+   * per-slot state kept out of line in the occupancy bitmap
+   * */
+  {
+    static_assert(sizeof(Slot<int>) == sizeof(SlotId));
+    static_assert(sizeof(Slot<int>) < sizeof(Element<int>));
+
+    VectorList<int> vector_list;
+    const BlockInfo<int>& info = vector_list.table_[0];
+    assert(info.size == INITIAL_BLOCK_SIZE);
+    assert(reinterpret_cast<char*>(info.slots + info.size + 2) - reinterpret_cast<char*>(info.slots) ==
+           static_cast<std::ptrdiff_t>((info.size + 2) * sizeof(SlotId)));
+  }
+
+  /*
+   * Every block, lock array, bitmap and generation array should come from the
+   * allocator, and all of it should be given back on destruction
+   * */
+  {
+    CountingResource resource;
+
+    {
+      pmr::VectorList<int> vector_list(&resource);
+      assert(vector_list.getAllocator().resource() == &resource);
+
+      // slots, locks, bitmap, generations and the list of blocks
+      assert(resource.allocations == 5);
+      assert(resource.bytes >= (INITIAL_BLOCK_SIZE + 2) * (sizeof(Slot<int>) + sizeof(std::atomic_flag)));
+
+      for (int i = 0; i < 1000; ++i) {
+        vector_list.emplace(i);
+      }
+      assert(resource.allocations == 4 * vector_list.table_.size() + 1);
+    }
+
+    assert(resource.allocations == 0);
+    assert(resource.bytes == 0);
+  }
+
+  /*
+   * A monotonic buffer should be able to back a container
+   * */
+  {
+    std::pmr::monotonic_buffer_resource arena;
+    pmr::VectorList<int> vector_list(&arena);
+
+    for (int i = 0; i < 1000; ++i) {
+      vector_list.emplace(i);
+    }
+    assert(vector_list.size() == 1000);
+  }
+
+  /*
+   * A copy should hold the same elements in the same places and
+   * be independent of the original, trimmed blocks included
+   * */
+  {
+    VectorList<int> vector_list;
+
+    for (int i = 0; i < 1000; ++i) {
+      vector_list.emplace(i);
+    }
+    vector_list.eraseIf([](int value) -> bool { return value < 100 || value % 3 == 0; });
+    vector_list.trim();
+
+    VectorList<int> copy(vector_list);
+    assert(copy.size() == vector_list.size());
+    assert(copy.capacity() == vector_list.capacity());
+
+    auto it = vector_list.begin();
+    for (auto copy_it = copy.begin(); copy_it != copy.end(); ++copy_it, ++it) {
+      assert(*copy_it == *it);
+      assert(copy_it.get() != it.get());
+    }
+    assert(it == vector_list.end());
+
+    // the copied free lists should hand out slots of the copy
+    size_t capacity = copy.capacity();
+    size_t num_free = capacity - copy.size();
+    for (size_t i = 0; i < num_free; ++i) {
+      copy.emplace(-1);
+    }
+    assert(copy.capacity() == capacity);
+    assert(vector_list.size() + num_free == copy.size());
+  }
+
+  /*
+   * Copying non-trivial elements should copy-construct each of them,
+   * and clear() should destroy them while keeping every block
+   * */
+  {
+    VectorList<NonTrivial> vector_list;
+
+    for (int i = 0; i < 100; ++i) {
+      vector_list.emplace()->data_[0] = i;
+    }
+    vector_list.eraseIf([](const NonTrivial& value) -> bool { return value.data_[0] % 3 == 0; });
+
+    VectorList<NonTrivial> copy(vector_list);
+
+    auto it = vector_list.begin();
+    for (auto copy_it = copy.begin(); copy_it != copy.end(); ++copy_it, ++it) {
+      assert(copy_it->data_[0] == it->data_[0]);
+      assert(copy_it->data_ != it->data_);
+    }
+
+    // the holes chained in the original and its fresh slots are Free in the copy
+    size_t capacity = copy.capacity();
+    while (copy.size() < capacity) {
+      copy.emplace()->data_[0] = -1;
+    }
+    assert(copy.capacity() == capacity);
+    assert(vector_list.size() == 66);
+    copy.clear();
+    assert(copy.size() == 0);
+    assert(copy.capacity() == capacity);
+    assert(copy.begin() == copy.end());
+    assert(copy.emptyBlocks() == copy.table_.size());
+
+    for (size_t i = 0; i < capacity; ++i) {
+      copy.emplace();
+    }
+    assert(copy.capacity() == capacity);
+  }
+
+  /*
+   * clear() on trivially destructible elements should only reset
+   * the bitmaps and leave every slot fresh without linking it, and
+   * handles from before should not find the elements inserted after
+   * */
+  {
+    VectorList<int> vector_list;
+    vector_list.insert(5000, 1);
+    Handle handle = vector_list.emplaceHandle(1);
+    size_t seen = 0;
+    vector_list.eraseIf([&seen](int) -> bool { return seen++ % 2 == 0; });
+    size_t capacity = vector_list.capacity();
+
+    vector_list.clear();
+    assert(vector_list.size() == 0);
+    assert(vector_list.begin() == vector_list.end());
+    assert(vector_list.emptyBlocks() == vector_list.table_.size());
+
+    for (size_t b = 0; b < vector_list.table_.size(); ++b) {
+      size_t id = vector_list.table_[b].id;
+      assert(vector_list.block_free_[id].head == NULL_SLOT && vector_list.block_free_[id].fresh == 1);
+    }
+
+    vector_list.insert(5000, 2);
+    vector_list.emplace(2);
+    assert(vector_list.capacity() == capacity);
+    assert(!vector_list.get(handle));
+
+    size_t count = 0;
+    for (auto it = vector_list.begin(); it != vector_list.end(); ++it) {
+      count += *it == 2;
+    }
+    assert(count == 5001);
+  }
 }
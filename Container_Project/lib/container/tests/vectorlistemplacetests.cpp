@@ -0,0 +1,132 @@
+#include "./test.hpp"
+#include "../vectorlist/vectorlist.hpp"
+
+template <> void vectorListEmplaceTests<int>( void )
+{
+  /*
+   * It should construct elements in-place and grow
+   * by a new block once the free list runs dry
+   * */
+  {
+    VectorList<int> vector_list;
+
+    for( int i = 0; i < INITIAL_BLOCK_SIZE + 1; ++i ) {
+      auto it = vector_list.emplace( i );
+
+      assert( it.getState() == ElementState::Alive );
+      assert( *it == i );
+    }
+
+    assert( vector_list.size() == INITIAL_BLOCK_SIZE + 1 );
+    assert( vector_list.capacity() == 2 * INITIAL_BLOCK_SIZE + BLOCK_INCREMENT );
+    assert( vector_list.blocks_.size() == 2 );
+  }
+
+  /*
+   * Removed slots should be reused before the
+   * container grows again
+   * */
+  {
+    VectorList<int> vector_list;
+    std::vector<VectorList<int>::iterator> its;
+
+    for( int i = 0; i < INITIAL_BLOCK_SIZE; ++i ) {
+      its.push_back( vector_list.emplace( i ) );
+    }
+
+    vector_list.remove( its[3] );
+    assert( its[3].getState() == ElementState::Free );
+    assert( vector_list.size() == INITIAL_BLOCK_SIZE - 1 );
+
+    assert( vector_list.emplace( 1337 ) == its[3] );
+    assert( vector_list.capacity() == INITIAL_BLOCK_SIZE );
+  }
+
+  /*
+   * Several producer threads should be able to insert at
+   * once, each one drawing from its own free list
+   * */
+  {
+    VectorList<int> vector_list;
+
+    const int num_threads = 4;
+    const int num_trials = 50000;
+
+    std::vector<std::thread> threads;
+    threads.reserve( num_threads );
+
+    std::unique_ptr<std::vector<VectorList<int>::iterator>[]> inserted{ new std::vector<VectorList<int>::iterator>[num_threads] };
+
+    for( int i = 0; i < num_threads; ++i ) {
+      threads.emplace_back( [=, &vector_list, &inserted](void) -> void {
+        inserted[i].reserve( num_trials );
+
+        for( int j = 0; j < num_trials; ++j ) {
+          inserted[i].push_back( vector_list.emplace( i * num_trials + j ) );
+        }
+      } );
+    }
+
+    for( auto& t : threads )
+      t.join();
+
+    assert( vector_list.size() == num_threads * num_trials );
+
+    std::vector<Slot<int>*> all;
+
+    for( int i = 0; i < num_threads; ++i ) {
+      for( int j = 0; j < num_trials; ++j ) {
+        assert( *inserted[i][j] == i * num_trials + j );
+        all.push_back( inserted[i][j].get() );
+      }
+    }
+
+    // no two threads should have been handed the same slot
+    std::sort( all.begin(), all.end() );
+    assert( std::adjacent_find( all.begin(), all.end() ) == all.end() );
+  }
+
+  /*
+   * Slots removed on one thread should flow back to the pool
+   * in batches and be reused by other threads without growth,
+   * while no thread cache holds more than THREAD_CACHE_SIZE slots
+   * */
+  {
+    VectorList<int> vector_list;
+
+    const int num_elements = 1000;
+    std::vector<VectorList<int>::iterator> its;
+
+    std::thread producer( [&](void) -> void {
+      for( int i = 0; i < num_elements; ++i ) {
+        its.push_back( vector_list.emplace( i ) );
+      }
+    } );
+    producer.join();
+
+    size_t capacity = vector_list.capacity();
+
+    std::thread consumer( [&](void) -> void {
+      for( auto& it : its ) {
+        vector_list.remove( it );
+      }
+    } );
+    consumer.join();
+
+    assert( vector_list.size() == 0 );
+
+    for( size_t i = 0; i < MAX_THREAD_CACHES; ++i ) {
+      assert( vector_list.caches_[i].count <= THREAD_CACHE_SIZE );
+    }
+
+    std::thread other_producer( [&](void) -> void {
+      for( int i = 0; i < num_elements - 2 * THREAD_CACHE_SIZE; ++i ) {
+        vector_list.emplace( i );
+      }
+    } );
+    other_producer.join();
+
+    assert( vector_list.size() == num_elements - 2 * THREAD_CACHE_SIZE );
+    assert( vector_list.capacity() == capacity );
+  }
+}
@@ -0,0 +1,102 @@
+#include "./test.hpp"
+#include "../vectorlist/vectorlist.hpp"
+
+template <> void vectorListGrowthTests<int>( void )
+{
+  const size_t slot_size = sizeof( Slot<int> );
+
+  /*
+   * Each policy should produce its sequence of block
+   * sizes and keep it within its limits
+   * */
+  {
+    typedef Utils::LinearGrowth<> Linear;
+    assert( Linear::initial( slot_size ) == INITIAL_BLOCK_SIZE );
+    assert( Linear::next( INITIAL_BLOCK_SIZE, slot_size ) == INITIAL_BLOCK_SIZE + BLOCK_INCREMENT );
+
+    typedef Utils::GeometricGrowth<16, 3, 2> Geometric;
+    assert( Geometric::initial( slot_size ) == 16 );
+    assert( Geometric::next( 16, slot_size ) == 24 );
+    assert( Geometric::next( 4, slot_size ) == 6 );
+    assert( Geometric::next( MAX_BLOCK_SIZE, slot_size ) == MAX_BLOCK_SIZE );
+
+    typedef Utils::CappedGeometricGrowth<16, 100> Capped;
+    size_t size = Capped::initial( slot_size );
+    for( int i = 0; i < 10; ++i ) {
+      size = Capped::next( size, slot_size );
+    }
+    assert( size == 100 );
+
+    typedef Utils::FixedGrowth<40> Fixed;
+    assert( Fixed::initial( slot_size ) == 40 );
+    assert( Fixed::next( 40, slot_size ) == 40 );
+
+    typedef Utils::PageMultipleGrowth<1> Pages;
+    size = Pages::initial( slot_size );
+    assert( ( size + 2 ) * slot_size == BLOCK_PAGE_SIZE );
+    size = Pages::next( size, slot_size );
+    assert( ( size + 2 ) * slot_size == 2 * BLOCK_PAGE_SIZE );
+  }
+
+  /*
+   * The container should size its blocks with its growth policy
+   * */
+  {
+    VectorList<int, Utils::BackoffPolicy, Utils::GeometricGrowth<> > vector_list;
+
+    for( int i = 0; i < 1000; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    size_t expected = INITIAL_BLOCK_SIZE;
+    for( size_t b = 0; b < vector_list.table_.size(); ++b ) {
+      assert( vector_list.table_[b].size == expected );
+      expected *= 2;
+    }
+    assert( vector_list.table_.size() == 6 );
+    assert( vector_list.size() == 1000 );
+  }
+
+  /*
+   * Reserving should allocate the missing capacity at once,
+   * and no more blocks should be needed until it is used up
+   * */
+  {
+    VectorList<int> vector_list;
+    const size_t n = 100000;
+
+    vector_list.reserve( n );
+    assert( vector_list.capacity() == n );
+    assert( vector_list.table_.size() == 2 );
+
+    vector_list.reserve( n / 2 );
+    assert( vector_list.capacity() == n );
+
+    for( size_t i = 0; i < n; ++i ) {
+      vector_list.emplace( static_cast<int>( i ) );
+    }
+    assert( vector_list.table_.size() == 2 );
+
+    size_t count = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      ++count;
+    }
+    assert( count == n );
+    assert( vector_list.size() == n );
+  }
+
+  /*
+   * Reserved blocks should respect the policy's maximum block size
+   * */
+  {
+    VectorList<int, Utils::BackoffPolicy, Utils::LinearGrowth<16, 16, 4, 64> > vector_list;
+
+    vector_list.reserve( 1000 );
+    assert( vector_list.capacity() >= 1000 );
+
+    for( size_t b = 0; b < vector_list.table_.size(); ++b ) {
+      assert( vector_list.table_[b].size <= 64 );
+    }
+    assert( vector_list.table_.size() == 1 + ( 1000 - INITIAL_BLOCK_SIZE + 63 ) / 64 );
+  }
+}
@@ -0,0 +1,191 @@
+#include "./test.hpp"
+#include "../vectorlist/vectorlist.hpp"
+
+template <> void vectorListHandleTests<int>( void )
+{
+  /*
+   * A Handle should find its element until it is removed
+   * and never the element that later reuses its slot
+   * */
+  {
+    VectorList<int> vector_list;
+
+    Handle handle = vector_list.emplaceHandle( 7 );
+    assert( vector_list.get( handle ) && *vector_list.get( handle ) == 7 );
+
+    int* value = vector_list.get( handle );
+    assert( vector_list.remove( handle ) );
+    assert( !vector_list.get( handle ) );
+    assert( !vector_list.remove( handle ) );
+
+    // the slot just freed is at the front of the cache
+    Handle reused = vector_list.emplaceHandle( 8 );
+    assert( vector_list.get( reused ) == value );
+    assert( reused != handle );
+    assert( !vector_list.get( handle ) );
+    assert( !vector_list.update( handle, []( int& ) -> void { assert( false ); } ) );
+    assert( !vector_list.remove( handle ) );
+    assert( vector_list.size() == 1 );
+
+    assert( vector_list.update( reused, []( int& v ) -> void { v = 9; } ) );
+    assert( *vector_list.get( reused ) == 9 );
+
+    assert( !vector_list.get( NULL_HANDLE ) );
+    assert( !vector_list.remove( NULL_HANDLE ) );
+  }
+
+  /*
+   * Handles should survive growth, come from iterators and
+   * bulk inserts alike and carry over to a copy
+   * */
+  {
+    VectorList<int> vector_list;
+    std::vector<Handle> handles;
+
+    vector_list.insert( 100, 1 );
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      handles.push_back( vector_list.handleOf( it ) );
+    }
+    for( int i = 0; i < 1000; ++i ) {
+      handles.push_back( vector_list.emplaceHandle( i ) );
+    }
+
+    for( size_t i = 0; i < handles.size(); ++i ) {
+      assert( *vector_list.get( handles[i] ) == ( i < 100 ? 1 : int( i - 100 ) ) );
+    }
+
+    for( size_t i = 0; i < handles.size(); i += 2 ) {
+      assert( vector_list.remove( handles[i] ) );
+    }
+
+    VectorList<int> copy( vector_list );
+
+    for( size_t i = 0; i < handles.size(); ++i ) {
+      assert( ( copy.get( handles[i] ) != nullptr ) == ( i % 2 == 1 ) );
+      if( i % 2 ) assert( *copy.get( handles[i] ) == *vector_list.get( handles[i] ) );
+    }
+  }
+
+  /*
+   * Handles into a trimmed block should read as removed,
+   * even once the block is reused as a spare
+   * */
+  {
+    VectorList<int> vector_list;
+    std::vector<Handle> handles;
+
+    for( int i = 0; i < 16; ++i ) {
+      handles.push_back( vector_list.emplaceHandle( i ) );
+    }
+    Handle kept = vector_list.emplaceHandle( 16 );
+
+    for( Handle handle : handles ) {
+      vector_list.remove( handle );
+    }
+    assert( vector_list.trim( 1 ) == 1 );
+
+    vector_list.insert( vector_list.capacity(), 0 );
+
+    for( Handle handle : handles ) {
+      assert( !vector_list.get( handle ) );
+    }
+    assert( *vector_list.get( kept ) == 16 );
+  }
+
+  /*
+   * Growing and trimming over and over should reuse block ids rather
+   * than run out of them, Handles from the first round staying stale
+   * long after more blocks than a Handle can name have come and gone
+   * */
+  {
+    VectorList<int, Utils::BackoffPolicy, Utils::FixedGrowth<2> > vector_list;
+    std::vector<Handle> first;
+    std::vector<Handle> last;
+
+    for( size_t round = 0; round < 2200; ++round ) {
+      last.clear();
+      for( int i = 0; i < 1000; ++i ) {
+        last.push_back( vector_list.emplaceHandle( i ) );
+      }
+      if( !round ) first = last;
+
+      assert( vector_list.table_.ids() <= 501 );
+      if( round + 1 == 2200 ) break;
+
+      vector_list.eraseIf( []( int ) -> bool { return true; } );
+      vector_list.shrinkToFit();
+    }
+
+    for( Handle handle : first ) {
+      assert( !vector_list.get( handle ) );
+    }
+    for( int i = 0; i < 1000; ++i ) {
+      int* value = vector_list.get( last[i] );
+      assert( value && *value == i );
+    }
+  }
+
+  /*
+   * An element that lands in a block whose id a Handle cannot hold
+   * should be removed again when emplaceHandle() throws
+   * */
+  {
+    VectorList<int, Utils::BackoffPolicy, Utils::FixedGrowth<4> > vector_list;
+    bool threw = false;
+
+    while( vector_list.table_.ids() < ( size_t( 1 ) << HANDLE_BLOCK_BITS ) ) {
+      vector_list.emplace( 1 );
+    }
+
+    while( !threw ) {
+      size_t size = vector_list.size();
+
+      try {
+        vector_list.emplaceHandle( 1 );
+      } catch( const std::length_error& ) {
+        threw = true;
+        assert( vector_list.size() == size );
+      }
+    }
+    assert( vector_list.table_.ids() > ( size_t( 1 ) << HANDLE_BLOCK_BITS ) );
+    assert( vector_list.size() == ( size_t( 1 ) << HANDLE_BLOCK_BITS ) * 4 );
+  }
+
+  /*
+   * Threads racing to remove the same elements through their
+   * Handles should remove each exactly once while others keep
+   * updating them
+   * */
+  {
+    VectorList<int> vector_list;
+    const int size = 10000;
+    const int num_threads = 4;
+    std::vector<Handle> handles;
+
+    for( int i = 0; i < size; ++i ) {
+      handles.push_back( vector_list.emplaceHandle( 0 ) );
+    }
+
+    std::atomic<int> removed{ 0 };
+    std::vector<std::thread> threads;
+
+    for( int t = 0; t < num_threads; ++t ) {
+      threads.emplace_back( [&, t]( void ) -> void {
+        for( int i = 0; i < size; ++i ) {
+          if( t % 2 ) {
+            vector_list.update( handles[i], []( int& v ) -> void { ++v; } );
+          } else if( vector_list.remove( handles[i] ) ) {
+            removed.fetch_add( 1, std::memory_order_relaxed );
+          }
+        }
+      } );
+    }
+
+    for( auto& thread : threads ) {
+      thread.join();
+    }
+
+    assert( removed.load() == size );
+    assert( vector_list.size() == 0 );
+  }
+}
@@ -0,0 +1,299 @@
+#include "./test.hpp"
+#include "../vectorlist/vectorlist.hpp"
+
+template <> void vectorListIteratorTests<int>( void )
+{
+  /*
+   * An empty VectorList should have begin() == end()
+   * */
+  {
+    VectorList<int> vector_list;
+    assert( vector_list.begin() == vector_list.end() );
+  }
+
+  /*
+   * We should be able to iterate forwards and backwards
+   * across several blocks
+   * */
+  {
+    VectorList<int> vector_list;
+    const int size = 128;
+
+    for( int i = 0; i < size; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    assert( vector_list.blocks_.size() > 1 );
+
+    int i = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it, ++i ) {
+      assert( *it == i );
+    }
+    assert( i == size );
+
+    for( auto it = vector_list.rend(); it != vector_list.rbegin(); --it ) {
+      assert( *it == --i );
+    }
+    assert( i == 0 );
+  }
+
+  /*
+   * Iteration should skip removed elements and it should be
+   * possible to remove through an iterator mid-loop
+   * */
+  {
+    VectorList<int> vector_list;
+    const int size = 128;
+
+    for( int i = 0; i < size; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      if( *it % 4 == 0 ) vector_list.remove( it );
+    }
+
+    int count = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it, ++count ) {
+      assert( *it % 4 != 0 );
+    }
+    assert( count == size - size / 4 );
+    assert( vector_list.size() == (size_t)count );
+  }
+
+  /*
+   * Readers should be able to iterate while another thread grows
+   * the container. Every pass ends on a tail Boundary, only ever
+   * sees constructed values and sees no fewer elements than the
+   * pass before it since nothing is being removed
+   * */
+  {
+    VectorList<int> vector_list;
+    const int size = 100000;
+    const int num_readers = 3;
+
+    std::atomic<bool> done{ false };
+    std::vector<std::thread> readers;
+
+    for( int r = 0; r < num_readers; ++r ) {
+      readers.emplace_back( [&](void) -> void {
+        size_t last_count = 0;
+
+        while( !done.load( std::memory_order_acquire ) ) {
+          size_t count = 0;
+
+          for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+            assert( *it >= 0 && *it < size );
+            ++count;
+          }
+
+          assert( count >= last_count );
+          last_count = count;
+        }
+      } );
+    }
+
+    std::thread writer( [&](void) -> void {
+      for( int i = 0; i < size; ++i ) {
+        vector_list.emplace( i );
+      }
+      done.store( true, std::memory_order_release );
+    } );
+
+    writer.join();
+    for( auto& t : readers )
+      t.join();
+
+    size_t count = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      ++count;
+    }
+    assert( count == size );
+  }
+
+  /*
+   * A sparse container should be iterable in both directions,
+   * including across blocks that have been emptied entirely,
+   * and the occupancy bitmaps and their summaries should agree
+   * with the live elements
+   * */
+  {
+    VectorList<int> vector_list;
+    const int size = 10000;
+
+    for( int i = 0; i < size; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      if( *it % 10 != 0 || ( *it > 2000 && *it < 6000 ) ) vector_list.remove( it );
+    }
+
+    std::vector<int> expected;
+    for( int i = 0; i < size; i += 10 ) {
+      if( i <= 2000 || i >= 6000 ) expected.push_back( i );
+    }
+
+    std::vector<int> forward;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      forward.push_back( *it );
+    }
+    assert( forward == expected );
+
+    std::vector<int> backward;
+    for( auto it = vector_list.rend(); it != vector_list.rbegin(); --it ) {
+      backward.push_back( *it );
+    }
+    std::reverse( backward.begin(), backward.end() );
+    assert( backward == expected );
+
+    size_t live = 0;
+    for( size_t b = 0; b < vector_list.table_.size(); ++b ) {
+      const BlockInfo<int>& info = vector_list.table_[b];
+
+      for( size_t i = 0; i < info.size; ++i ) {
+        bool bit = info.occupancy[i / BITMAP_WORD_BITS] & ( uint64_t( 1 ) << ( i % BITMAP_WORD_BITS ) );
+        if( bit ) assert( std::binary_search( expected.begin(), expected.end(), info.slots[i + 1].get() ) );
+        live += bit;
+      }
+
+      for( size_t w = 0; w < Utils::bitmapWords( info.size ); ++w ) {
+        if( info.occupancy[w] ) assert( Utils::testBit( info.summary, w ) );
+      }
+    }
+    assert( live == expected.size() );
+    assert( vector_list.size() == expected.size() );
+  }
+
+  /*
+   * The iterator should model a standard bidirectional
+   * iterator and work with the standard algorithms
+   * */
+  {
+    static_assert( std::bidirectional_iterator<VectorList<int>::iterator> );
+    static_assert( std::forward_iterator<VectorList<int>::segment::iterator> );
+
+    VectorList<int> vector_list;
+
+    for( int i = 0; i < 100; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    auto it = vector_list.begin();
+    assert( *it++ == 0 && *it == 1 );
+    assert( *it-- == 1 && *it == 0 );
+    assert( std::distance( vector_list.begin(), vector_list.end() ) == 100 );
+    assert( std::find( vector_list.begin(), vector_list.end(), 42 ) != vector_list.end() );
+    assert( VectorList<int>::iterator() == VectorList<int>::iterator() );
+  }
+
+  /*
+   * Segments should cover every Alive Element exactly once, through
+   * both their iterators and forEach(), with full and partly full
+   * words and retired blocks in the mix
+   * */
+  {
+    VectorList<int> vector_list;
+    const int size = 1000;
+
+    for( int i = 0; i < size; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    vector_list.eraseIf( []( int value ) -> bool { return value % 5 == 0 || ( value >= 16 && value < 48 ); } );
+
+    size_t num_blocks = vector_list.table_.size();
+    vector_list.trim( 0 );
+
+    std::vector<int> expected( vector_list.begin(), vector_list.end() );
+    std::vector<int> iterated;
+    std::vector<int> visited;
+    size_t num_segments = 0;
+
+    for( auto segment : vector_list.segments() ) {
+      assert( segment.data() == vector_list.table_[segment.block()].slots );
+
+      for( int value : segment ) {
+        iterated.push_back( value );
+      }
+      segment.forEach( [&]( int value ) -> void { visited.push_back( value ); } );
+      ++num_segments;
+    }
+
+    assert( iterated == expected );
+    assert( visited == expected );
+    assert( num_segments < num_blocks );
+    assert( num_segments == vector_list.table_.size() );
+  }
+
+  /*
+   * forEach() should take the dense path over full words
+   * and still visit each element once
+   * */
+  {
+    VectorList<int> vector_list;
+    vector_list.insert( 1000, 1 );
+
+    int sum = 0;
+    for( auto segment : vector_list.segments() ) {
+      segment.forEach( [&]( int& value ) -> void { sum += value++; } );
+    }
+    assert( sum == 1000 );
+    assert( std::count( vector_list.begin(), vector_list.end(), 2 ) == 1000 );
+  }
+
+  /*
+   * Slot numbers should map to elements and back in both
+   * directions, across trimmed blocks too, and even splits of
+   * [0, capacity()) should cover every element once
+   * */
+  {
+    VectorList<int> vector_list;
+    const int size = 2000;
+
+    for( int i = 0; i < size; ++i ) {
+      vector_list.emplace( i );
+    }
+    vector_list.eraseIf( []( int value ) -> bool { return value < 16 || ( value >= 48 && value < 96 ) || value % 3 == 0; } );
+    vector_list.trim( 0 );
+
+    size_t capacity = vector_list.capacity();
+    assert( vector_list.indexOf( vector_list.end() ) == capacity );
+    assert( !vector_list.slotAt( capacity ) );
+    assert( vector_list.iteratorAt( capacity ) == vector_list.end() );
+
+    size_t alive = 0;
+    for( size_t k = 0; k < capacity; ++k ) {
+      int* value = vector_list.slotAt( k );
+      if( !value ) continue;
+
+      auto it = vector_list.iteratorAt( k );
+      assert( &*it == value );
+      assert( vector_list.indexOf( it ) == k );
+      ++alive;
+    }
+    assert( alive == vector_list.size() );
+
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      assert( vector_list.slotAt( vector_list.indexOf( it ) ) == &*it );
+    }
+
+    const size_t num_shards = 4;
+    std::vector<int> sharded;
+
+    for( size_t s = 0; s < num_shards; ++s ) {
+      size_t first = capacity * s / num_shards;
+      size_t last = capacity * ( s + 1 ) / num_shards;
+
+      for( auto it = vector_list.iteratorAt( first ); it != vector_list.end() && vector_list.indexOf( it ) < last; ++it ) {
+        sharded.push_back( *it );
+      }
+    }
+    assert( sharded == std::vector<int>( vector_list.begin(), vector_list.end() ) );
+
+    VectorList<int> copy( vector_list );
+    for( size_t k = 0; k < capacity; ++k ) {
+      assert( ( copy.slotAt( k ) != nullptr ) == ( vector_list.slotAt( k ) != nullptr ) );
+    }
+  }
+}
@@ -0,0 +1,160 @@
+#include "./test.hpp"
+#include "../vectorlist/vectorlist.hpp"
+
+template <> void vectorListLockTests<int>( void )
+{
+  /*
+   * Threads should be able to mutate elements in place
+   * concurrently, serialised only on the element they touch
+   * */
+  {
+    VectorList<int> vector_list;
+    const int size = 40;
+
+    for( int i = 0; i < size; ++i ) {
+      vector_list.emplace( 0 );
+    }
+
+    std::vector<VectorList<int>::iterator> its;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      its.push_back( it );
+    }
+
+    const int num_threads = 4;
+    const int num_trials = 100000;
+    std::vector<std::thread> threads;
+
+    for( int i = 0; i < num_threads; ++i ) {
+      threads.emplace_back( [&](void) -> void {
+        std::random_device rd;
+        std::mt19937 gen{ rd() };
+        std::uniform_int_distribution<> range{ 0, size - 1 };
+
+        for( int j = 0; j < num_trials; ++j ) {
+          vector_list.withLocked( its[range( gen )], []( int& value ) -> void { ++value; } );
+        }
+      } );
+    }
+
+    for( auto& t : threads )
+      t.join();
+
+    int sum = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      sum += *it;
+    }
+
+    assert( sum == num_threads * num_trials );
+  }
+
+  /*
+   * withLocked() should forward the return value of the functor
+   * */
+  {
+    VectorList<int> vector_list;
+    vector_list.emplace( 1336 );
+
+    auto it = vector_list.begin();
+    assert( vector_list.withLocked( it, []( int& value ) -> int { return ++value; } ) == 1337 );
+  }
+
+  /*
+   * withLocked() waiting on an element that gets removed meanwhile
+   * should not call its functor
+   * */
+  {
+    VectorList<int> vector_list;
+    vector_list.emplace( 0 );
+
+    auto it = vector_list.begin();
+    std::atomic_flag& lock = vector_list.getLock( it );
+    std::atomic<bool> waiting{ false };
+    bool called = false;
+    bool ran = true;
+    std::optional<int> value{ 0 };
+
+    Utils::BackoffPolicy::lock( lock );
+
+    std::thread t( [&](void) -> void {
+      auto mine = it;
+      waiting = true;
+      ran = vector_list.withLocked( mine, [&]( int& ) -> void { called = true; } );
+      value = vector_list.withLocked( mine, []( int& v ) -> int { return v; } );
+    } );
+
+    while( !waiting ) {
+      std::this_thread::yield();
+    }
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+
+    // what remove() does once it holds the element lock
+    const BlockInfo<int>& info = vector_list.table_[0];
+    assert( &*it == &info.slots[1].get() );
+    vector_list.removeAt( info.id, info.slots + 1 );
+    Utils::BackoffPolicy::unlock( lock );
+
+    t.join();
+
+    assert( !ran );
+    assert( !called );
+    assert( !value );
+    assert( vector_list.size() == 0 );
+  }
+
+  /*
+   * Threads racing to remove the same elements through their
+   * iterators should remove each exactly once
+   * */
+  {
+    VectorList<int> vector_list;
+    const int size = 10000;
+
+    vector_list.insert( size, 1 );
+
+    std::vector<VectorList<int>::iterator> its;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      its.push_back( it );
+    }
+
+    const int num_threads = 4;
+    std::atomic<int> removed{ 0 };
+    std::vector<std::thread> threads;
+
+    for( int i = 0; i < num_threads; ++i ) {
+      threads.emplace_back( [&](void) -> void {
+        auto mine = its;
+        for( auto& it : mine ) {
+          if( vector_list.remove( it ) ) ++removed;
+        }
+      } );
+    }
+
+    for( auto& t : threads )
+      t.join();
+
+    assert( removed == size );
+    assert( vector_list.size() == 0 );
+    assert( vector_list.begin() == vector_list.end() );
+  }
+
+  /*
+   * tryUpdate() should fail instead of waiting on a locked
+   * element and should refuse elements that were removed
+   * */
+  {
+    VectorList<int> vector_list;
+    vector_list.emplace( 0 );
+
+    auto it = vector_list.begin();
+
+    vector_list.withLocked( it, [&]( int& ) -> void {
+      assert( !vector_list.tryUpdate( it, []( int& value ) -> void { ++value; } ) );
+    } );
+
+    assert( vector_list.tryUpdate( it, []( int& value ) -> void { value = 1337; } ) );
+    assert( *it == 1337 );
+
+    vector_list.remove( it );
+    assert( !vector_list.tryUpdate( it, []( int& value ) -> void { ++value; } ) );
+  }
+}
@@ -0,0 +1,264 @@
+#include <latch>
+
+#include "./test.hpp"
+#include "../vectorlist/vectorlist.hpp"
+
+template <> void vectorListNodeTests<int>( void )
+{
+  typedef VectorList<int, Utils::BackoffPolicy, Utils::LinearGrowth<>, std::allocator<int>, Utils::NoStats, Utils::FakeNodes<2> >
+    NodeList;
+
+  // every free slot of a cache should be in a block for its node, every block
+  // of a pool should be for its node and hold only free slots of its own
+  auto freeListsHome = []( NodeList& vector_list ) -> bool {
+    auto home = [&]( FreeCache& cache ) -> bool {
+      for( SlotId slot = cache.head; slot != NULL_SLOT; slot = vector_list.getSlot( slot )->getNextSlot() ) {
+        if( vector_list.table_.byId( Utils::slotBlock( slot ) ).node != cache.node ) return false;
+      }
+      return true;
+    };
+
+    for( size_t node = 0; node < vector_list.nodes(); ++node ) {
+      FreePool& pool = vector_list.pools_[node];
+      size_t count = 0;
+
+      if( pool.node != node ) return false;
+
+      for( size_t id = pool.first; id != NULL_BLOCK; id = vector_list.block_free_[id].next ) {
+        if( vector_list.table_.byId( id ).node != node ) return false;
+
+        for( SlotId slot = vector_list.block_free_[id].head; slot != NULL_SLOT; slot = vector_list.getSlot( slot )->getNextSlot() ) {
+          if( Utils::slotBlock( slot ) != id ) return false;
+        }
+        count += vector_list.freeIn( id );
+      }
+
+      if( count != pool.count ) return false;
+    }
+    for( size_t i = 0; i < MAX_THREAD_CACHES; ++i ) {
+      if( !home( vector_list.caches_[i] ) ) return false;
+    }
+    return true;
+  };
+
+  // insert from threads that all run at once, so their thread indices differ and both nodes are used
+  auto fillFromThreads = []( NodeList& vector_list, int num_threads, int per_thread ) -> void {
+    std::latch done( num_threads );
+    std::vector<std::thread> threads;
+
+    for( int t = 0; t < num_threads; ++t ) {
+      threads.emplace_back( [&, t]( void ) -> void {
+        size_t node = Utils::FakeNodes<2>::currentNode();
+
+        for( int i = 0; i < per_thread; ++i ) {
+          auto it = vector_list.emplace( t * per_thread + i );
+          assert( vector_list.nodeOf( it ) == node );
+        }
+        done.arrive_and_wait();
+      } );
+    }
+
+    for( auto& thread : threads ) {
+      thread.join();
+    }
+  };
+
+  /*
+   * By default there should be a single node holding every block
+   * */
+  {
+    VectorList<int> vector_list;
+
+    for( int i = 0; i < 100; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    assert( vector_list.nodes() == 1 );
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      assert( vector_list.nodeOf( it ) == 0 );
+    }
+  }
+
+  /*
+   * Each thread should insert into blocks for its own node,
+   * which then only hold the elements of threads on that node
+   * */
+  {
+    NodeList vector_list;
+    const int num_threads = 4;
+    const int per_thread = 500;
+
+    assert( vector_list.nodes() == 2 );
+    assert( vector_list.table_[0].node == Utils::FakeNodes<2>::currentNode() );
+
+    fillFromThreads( vector_list, num_threads, per_thread );
+    assert( vector_list.size() == num_threads * per_thread );
+
+    size_t blocks[2] = {};
+    for( size_t b = 0; b < vector_list.table_.size(); ++b ) {
+      ++blocks[vector_list.table_[b].node];
+    }
+    assert( blocks[0] > 0 && blocks[1] > 0 );
+
+    assert( freeListsHome( vector_list ) );
+  }
+
+  /*
+   * An element removed on another node should go back to the
+   * pool of its own node, not to the remover's cache
+   * */
+  {
+    NodeList vector_list;
+    size_t here = Utils::FakeNodes<2>::currentNode();
+
+    fillFromThreads( vector_list, 4, 200 );
+
+    auto remote = vector_list.begin();
+    while( vector_list.nodeOf( remote ) == here ) {
+      ++remote;
+    }
+
+    size_t there = vector_list.nodeOf( remote );
+    FreeCache* cache = vector_list.getCache();
+    size_t cached = cache->count;
+    size_t pooled = vector_list.pools_[there].count;
+
+    vector_list.remove( remote );
+
+    assert( cache->count == cached );
+    assert( vector_list.pools_[there].count == pooled + 1 );
+    assert( vector_list.size() == 799 );
+
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      vector_list.remove( it );
+    }
+    assert( vector_list.size() == 0 );
+    assert( freeListsHome( vector_list ) );
+  }
+
+  /*
+   * Segments and parallel scans restricted to a node should see
+   * only its blocks, and the nodes together should see everything
+   * */
+  {
+    NodeList vector_list;
+    fillFromThreads( vector_list, 4, 1000 );
+
+    size_t seen = 0;
+    for( size_t node = 0; node < vector_list.nodes(); ++node ) {
+      size_t in_segments = 0;
+
+      for( auto segment : vector_list.segments( node ) ) {
+        assert( vector_list.table_[segment.block()].node == node );
+        segment.forEach( [&]( int& ) -> void { ++in_segments; } );
+      }
+
+      size_t in_reduce = vector_list.parallelReduce(
+        size_t( 0 ), []( int& ) -> size_t { return 1; }, []( size_t a, size_t b ) -> size_t { return a + b; }, 2, node );
+
+      std::atomic<size_t> in_for_each{ 0 };
+      vector_list.parallelForEach( [&]( int& ) -> void { in_for_each.fetch_add( 1 ); }, 2, node );
+
+      assert( in_segments == in_reduce && in_reduce == in_for_each.load() );
+      seen += in_reduce;
+    }
+    assert( seen == vector_list.size() );
+  }
+
+  /*
+   * Erasing on one node should leave the other untouched and
+   * give the freed slots to the pool of the erased node
+   * */
+  {
+    NodeList vector_list;
+    fillFromThreads( vector_list, 4, 1000 );
+
+    size_t counts[2] = {};
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      ++counts[vector_list.nodeOf( it )];
+    }
+
+    size_t pooled = vector_list.pools_[1].count;
+    size_t erased = vector_list.parallelEraseIf( []( int& ) -> bool { return true; }, 2, 1 );
+
+    assert( erased == counts[1] );
+    assert( vector_list.pools_[1].count == pooled + erased );
+    assert( vector_list.size() == counts[0] );
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      assert( vector_list.nodeOf( it ) == 0 );
+    }
+
+    vector_list.eraseIf( []( int value ) -> bool { return value % 2 == 0; } );
+    assert( freeListsHome( vector_list ) );
+  }
+
+  /*
+   * clear() should give every slot back to the pool of its node
+   * and a copy should keep the node of every block
+   * */
+  {
+    NodeList vector_list;
+    fillFromThreads( vector_list, 4, 300 );
+
+    NodeList copy( vector_list );
+    assert( copy.size() == vector_list.size() );
+    for( size_t b = 0; b < vector_list.table_.size(); ++b ) {
+      assert( copy.table_[b].node == vector_list.table_[b].node );
+    }
+
+    vector_list.clear();
+
+    size_t capacity[2] = {};
+    for( size_t b = 0; b < vector_list.table_.size(); ++b ) {
+      capacity[vector_list.table_[b].node] += vector_list.table_[b].size;
+    }
+
+    assert( vector_list.size() == 0 );
+    assert( vector_list.pools_[0].count == capacity[0] );
+    assert( vector_list.pools_[1].count == capacity[1] );
+    assert( freeListsHome( vector_list ) );
+  }
+
+  /*
+   * A block kept aside by trim() should only be reused by growth
+   * on the node it was for
+   * */
+  {
+    NodeList vector_list;
+    fillFromThreads( vector_list, 4, 300 );
+
+    vector_list.eraseIf( []( int& ) -> bool { return true; } );
+    vector_list.trim( vector_list.table_.size() );
+
+    assert( vector_list.spares_.size() == vector_list.spare_nodes_.size() );
+
+    while( !vector_list.spares_.empty() ) {
+      size_t node = vector_list.spare_nodes_.back();
+      Slot<int>* slots = std::get<SlotPtr<int, std::allocator<int> > >( vector_list.spares_.back() ).get();
+
+      vector_list.grow( node );
+      assert( vector_list.table_[vector_list.table_.size() - 1].slots == slots );
+      assert( vector_list.table_[vector_list.table_.size() - 1].node == node );
+    }
+    assert( vector_list.spare_nodes_.empty() );
+  }
+
+#ifdef CONTAINER_HAVE_NUMA
+  /*
+   * On the real topology every block should be for a node that
+   * exists, which on a single node machine is node 0
+   * */
+  {
+    VectorList<int, Utils::BackoffPolicy, Utils::LinearGrowth<>, std::allocator<int>, Utils::NoStats, Utils::NumaNodes> vector_list;
+
+    for( int i = 0; i < 10000; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    assert( vector_list.size() == 10000 );
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      assert( vector_list.nodeOf( it ) < vector_list.nodes() );
+    }
+  }
+#endif
+}
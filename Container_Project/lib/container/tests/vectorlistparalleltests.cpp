@@ -0,0 +1,194 @@
+#include <mutex>
+#include <numeric>
+#include <set>
+
+#include "./test.hpp"
+#include "../vectorlist/vectorlist.hpp"
+
+template <> void vectorListParallelTests<int>( void )
+{
+  const size_t num_threads = 4;
+
+  /*
+   * parallelForEach() should visit every Alive Element exactly
+   * once, including in blocks larger than one chunk
+   * */
+  {
+    VectorList<int> vector_list;
+    const int size = 50000;
+
+    vector_list.insert( size, 0 );
+    for( int i = 0; i < 100; ++i ) {
+      vector_list.emplace( 0 );
+    }
+    assert( vector_list.table_[1].size > PARALLEL_CHUNK_WORDS * BITMAP_WORD_BITS );
+
+    vector_list.parallelForEach( []( int& value ) -> void { ++value; }, num_threads );
+
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      assert( *it == 1 );
+    }
+  }
+
+  /*
+   * parallelReduce() should agree with a serial reduction and
+   * return init when there is nothing to reduce
+   * */
+  {
+    VectorList<int> vector_list;
+
+    for( int i = 0; i < 20000; ++i ) {
+      vector_list.emplace( i );
+    }
+    vector_list.eraseIf( []( int value ) -> bool { return value % 7 == 0; } );
+
+    long long expected = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      expected += *it;
+    }
+
+    auto sum = []( long long a, long long b ) -> long long { return a + b; };
+    auto identity = []( int value ) -> long long { return value; };
+
+    assert( vector_list.parallelReduce( 0LL, identity, sum, num_threads ) == expected );
+    assert( vector_list.parallelReduce( 5LL, identity, sum, 1 ) == expected + 5 );
+
+    VectorList<int> empty;
+    assert( empty.parallelReduce( 42LL, identity, sum, num_threads ) == 42 );
+  }
+
+  /*
+   * parallelEraseIf() should remove exactly the matching elements
+   * and leave consistent free lists behind
+   * */
+  {
+    VectorList<int> vector_list;
+    const int size = 30000;
+
+    for( int i = 0; i < size; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    size_t erased = vector_list.parallelEraseIf( []( int value ) -> bool { return value % 3 != 0; }, num_threads );
+    assert( erased == size - size / 3 );
+    assert( vector_list.size() == size / 3 );
+
+    size_t count = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      assert( *it % 3 == 0 );
+      ++count;
+    }
+    assert( count == size / 3 );
+
+    size_t capacity = vector_list.capacity();
+    vector_list.insert( erased, -1 );
+    assert( vector_list.capacity() == capacity );
+  }
+
+  /*
+   * A throwing predicate should leave no element locked and
+   * give the slots erased on every thread back to the pool
+   * */
+  {
+    VectorList<int> vector_list;
+    const int size = 30000;
+
+    for( int i = 0; i < size; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    bool thrown = false;
+
+    try {
+      vector_list.parallelEraseIf(
+        []( int value ) -> bool {
+          if( value == size / 2 + 1 ) throw std::runtime_error( "pred failed" );
+          return value % 2 == 0;
+        },
+        num_threads );
+    } catch( const std::runtime_error& ) {
+      thrown = true;
+    }
+    assert( thrown );
+
+    size_t count = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      assert( vector_list.tryUpdate( it, []( int& ) -> void {} ) );
+      ++count;
+    }
+    assert( count == vector_list.size() );
+    assert( count < size );
+
+    size_t capacity = vector_list.capacity();
+    vector_list.insert( capacity - vector_list.size(), -1 );
+    assert( vector_list.capacity() == capacity );
+  }
+
+  /*
+   * An exception thrown on any thread should reach the caller
+   * */
+  {
+    VectorList<int> vector_list;
+    vector_list.insert( 10000, 1 );
+
+    bool thrown = false;
+
+    try {
+      vector_list.parallelForEach(
+        []( int& value ) -> void {
+          if( value == 1 ) throw std::runtime_error( "visited" );
+        },
+        num_threads );
+    } catch( const std::runtime_error& ) {
+      thrown = true;
+    }
+
+    assert( thrown );
+  }
+
+  /*
+   * Parallel calls should run on the same threads again and again,
+   * and one made from inside another should still finish
+   * */
+  {
+    VectorList<int> vector_list;
+    vector_list.insert( 100000, 1 );
+
+    std::mutex lock;
+    std::set<std::thread::id> seen;
+
+    for( int i = 0; i < 20; ++i ) {
+      vector_list.parallelForEach(
+        [&]( int& ) -> void {
+          std::lock_guard<std::mutex> guard( lock );
+          seen.insert( std::this_thread::get_id() );
+        },
+        num_threads );
+    }
+    assert( seen.size() <= num_threads );
+
+    // asking for more threads than there are cores leaves no more
+    // workers behind than the cores can run
+    std::atomic<size_t> visited{ 0 };
+    vector_list.parallelForEach( [&]( int& ) -> void { ++visited; }, 1000 );
+    assert( visited == vector_list.size() );
+    assert( Utils::WorkerPool::shared().size() < std::max<size_t>( 2, std::thread::hardware_concurrency() ) );
+
+    VectorList<int> outer;
+    VectorList<int> inner;
+    std::vector<int> values( 100000 );
+    std::iota( values.begin(), values.end(), 0 );
+    outer.insert( values.begin(), values.end() );
+    inner.insert( 1000, 1 );
+
+    std::atomic<long long> total{ 0 };
+    outer.parallelForEach(
+      [&]( int& value ) -> void {
+        if( value % 10000 ) return;
+        total.fetch_add( inner.parallelReduce( 0LL, []( int v ) -> long long { return v; },
+                                               []( long long a, long long b ) -> long long { return a + b; }, 2 ) );
+      },
+      num_threads );
+    assert( total.load() == 10LL * 1000 );
+  }
+}
@@ -0,0 +1,342 @@
+#include <filesystem>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "./test.hpp"
+#include "../vectorlist/vectorlist.hpp"
+
+template <> void vectorListPersistenceTests<int>( void )
+{
+  typedef pmr::VectorList<int> MappedList;
+
+  std::string path = ( std::filesystem::temp_directory_path() / ( "vectorlist-" + std::to_string( getpid() ) + ".map" ) ).string();
+
+  auto sumOf = []( MappedList& vector_list ) -> int64_t {
+    int64_t sum = 0;
+    for( auto segment : vector_list.segments() ) {
+      segment.forEach( [&]( int& value ) -> void { sum += value; } );
+    }
+    return sum;
+  };
+
+  /*
+   * Memory freed in a file should be handed out again,
+   * also after the file was closed and opened again
+   * */
+  {
+    uint64_t offset;
+
+    {
+      Utils::MappedFile file( path, Utils::MapMode::Create );
+
+      void* first = file.allocate( 100 );
+      offset = file.offsetOf( first );
+      assert( offset % CACHE_LINE_SIZE == 0 );
+      assert( file.at( offset, 100 ) == first );
+
+      assert( file.allocate( 1000 ) != first );
+      file.deallocate( first, 100 );
+    }
+
+    Utils::MappedFile file( path, Utils::MapMode::Open );
+    size_t used = file.used();
+
+    void* again = file.allocate( 64 );
+    assert( file.offsetOf( again ) == offset );
+    assert( file.used() == used );
+
+    /*
+     * Neighbouring free extents should merge, and memory freed at the
+     * end of the used bytes should no longer count as used
+     * */
+    void* second = file.allocate( 64 );
+    file.deallocate( again, 64 );
+    file.deallocate( second, 64 );
+    assert( file.offsetOf( file.allocate( 128 ) ) == offset );
+
+    void* last = file.allocate( 4096 );
+    assert( file.used() == used + 4096 );
+    file.deallocate( last, 4096 );
+    assert( file.used() == used );
+  }
+
+  /*
+   * A container should come back from its file with the same
+   * elements, and handles made before should still work
+   * */
+  std::vector<Handle> handles;
+  size_t size;
+  int64_t sum;
+
+  {
+    Utils::MappedFile file( path, Utils::MapMode::Create );
+    MappedList vector_list( file );
+
+    for( int i = 0; i < 100000; ++i ) {
+      Handle handle = vector_list.emplaceHandle( i );
+      if( i % 1000 == 0 ) handles.push_back( handle );
+    }
+    vector_list.eraseIf( []( int value ) -> bool { return value % 3 == 1; } );
+
+    size = vector_list.size();
+    sum = sumOf( vector_list );
+  }
+
+  size_t capacity;
+
+  {
+    Utils::MappedFile file( path, Utils::MapMode::Open );
+    MappedList vector_list( file );
+
+    assert( vector_list.size() == size );
+    assert( sumOf( vector_list ) == sum );
+
+    size_t count = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      ++count;
+    }
+    assert( count == size );
+
+    for( size_t i = 0; i < handles.size(); ++i ) {
+      int* value = vector_list.get( handles[i] );
+      int expected = int( i * 1000 );
+      assert( expected % 3 == 1 ? !value : value && *value == expected );
+    }
+
+    // the free slots came back too, so refilling needs no new block
+    capacity = vector_list.capacity();
+    for( int i = 0; i < 1000; ++i ) {
+      vector_list.emplace( -1 );
+    }
+    assert( vector_list.capacity() == capacity );
+    assert( vector_list.size() == size + 1000 );
+  }
+
+  /*
+   * Read only views should see the last synced state, and what
+   * they change should never reach the file
+   * */
+  {
+    Utils::MappedFile first_file( path, Utils::MapMode::ReadOnly );
+    Utils::MappedFile second_file( path, Utils::MapMode::ReadOnly );
+    MappedList first( first_file );
+    MappedList second( second_file );
+
+    assert( first.size() == size + 1000 );
+    assert( second.size() == size + 1000 );
+    assert( sumOf( first ) == sum - 1000 );
+
+    first.eraseIf( []( int ) -> bool { return true; } );
+    assert( first.size() == 0 );
+    assert( second.size() == size + 1000 );
+    assert( sumOf( second ) == sum - 1000 );
+
+    // growing takes its blocks from the heap
+    for( size_t i = 0; i <= capacity; ++i ) {
+      first.emplace( 1 );
+    }
+    assert( first.capacity() > capacity );
+    assert( sumOf( first ) == int64_t( capacity ) + 1 );
+  }
+
+  {
+    Utils::MappedFile file( path, Utils::MapMode::Open );
+    MappedList vector_list( file );
+
+    assert( vector_list.size() == size + 1000 );
+
+    /*
+     * Trimmed blocks should go back to the file for growth to use,
+     * so refilling never needs more of the file than before
+     * */
+    size_t used = file.used();
+
+    vector_list.eraseIf( []( int ) -> bool { return true; } );
+    vector_list.shrinkToFit();
+    vector_list.sync();
+    assert( file.used() < used );
+
+    for( int i = 0; i < 50000; ++i ) {
+      vector_list.emplace( i );
+    }
+    assert( file.used() <= used );
+  }
+
+  /*
+   * A copy of the file taken while its container is open is what a
+   * process that died leaves behind. It should open dirty with every
+   * element there was, the Free slots found again from the bitmaps
+   * and the blocks trimmed since the last sync back, empty
+   * */
+  {
+    std::string crash_path = path + ".crash";
+    size_t synced_capacity;
+
+    {
+      Utils::MappedFile file( path, Utils::MapMode::Create );
+      MappedList vector_list( file );
+      assert( !file.clean() );
+
+      for( int i = 0; i < 100000; ++i ) {
+        vector_list.emplace( i );
+      }
+      vector_list.sync();
+      synced_capacity = vector_list.capacity();
+
+      // the free chains synced end up running through Alive slots
+      vector_list.eraseIf( []( int value ) -> bool { return value < 1000 || value % 7 == 0; } );
+      assert( vector_list.trim() > 0 );
+
+      size_t capacity = vector_list.capacity();
+      for( int i = 0; i < 2000; ++i ) {
+        vector_list.emplace( -1 );
+      }
+      assert( vector_list.capacity() == capacity );
+
+      size = vector_list.size();
+      sum = sumOf( vector_list );
+
+      std::filesystem::copy_file( path, crash_path, std::filesystem::copy_options::overwrite_existing );
+    }
+
+    {
+      Utils::MappedFile file( crash_path, Utils::MapMode::Open );
+      assert( !file.clean() );
+      MappedList vector_list( file );
+
+      assert( vector_list.size() == size );
+      assert( sumOf( vector_list ) == sum );
+      assert( vector_list.capacity() == synced_capacity );
+      assert( vector_list.emptyBlocks() > 0 );
+
+      size_t count = 0;
+      for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+        ++count;
+      }
+      assert( count == size );
+
+      // every slot found Free really is, so filling them overwrites nothing
+      while( vector_list.size() < synced_capacity ) {
+        vector_list.emplace( 1 );
+      }
+      assert( vector_list.capacity() == synced_capacity );
+      assert( sumOf( vector_list ) == sum + int64_t( synced_capacity - size ) );
+    }
+
+    Utils::MappedFile file( crash_path, Utils::MapMode::Open );
+    assert( file.clean() );
+
+    std::filesystem::remove( crash_path );
+  }
+
+  /*
+   * A file should only open as a container of the element type it was
+   * made for, and a file that holds no container should not open at all
+   * */
+  {
+    struct Wide
+    {
+      int64_t values[4];
+    };
+
+    Utils::MappedFile file( path, Utils::MapMode::Open );
+
+    bool threw = false;
+    try {
+      pmr::VectorList<Wide> vector_list( file );
+    } catch( const std::runtime_error& ) {
+      threw = true;
+    }
+    assert( threw );
+  }
+
+  /*
+   * A file should have either one writer or any number of readers
+   * */
+  {
+    auto opens = [&]( Utils::MapMode mode ) -> bool {
+      try {
+        Utils::MappedFile file( path, mode );
+      } catch( const std::runtime_error& ) {
+        return false;
+      }
+      return true;
+    };
+
+    {
+      Utils::MappedFile writer( path, Utils::MapMode::Open );
+      assert( !opens( Utils::MapMode::ReadOnly ) );
+      assert( !opens( Utils::MapMode::Open ) );
+      assert( !opens( Utils::MapMode::Create ) );
+    }
+
+    Utils::MappedFile reader( path, Utils::MapMode::ReadOnly );
+    assert( opens( Utils::MapMode::ReadOnly ) );
+    assert( !opens( Utils::MapMode::Open ) );
+    assert( !opens( Utils::MapMode::Create ) );
+  }
+
+  /*
+   * A file whose state names arrays past its end, blocks too large
+   * or an order that does not add up should not open, and should
+   * open again once its state is whole
+   * */
+  {
+    Utils::MappedFile file( path, Utils::MapMode::Open );
+    auto* list = static_cast<PersistentList*>( file.at( file.root(), sizeof( PersistentList ) ) );
+    auto* records = static_cast<PersistentBlock*>( file.at( list->blocks, list->num_blocks * sizeof( PersistentBlock ) ) );
+    auto* order = static_cast<uint64_t*>( file.at( list->order, list->num_ordered * sizeof( uint64_t ) ) );
+    PersistentBlock& record = records[order[0]];
+
+    auto refused = [&]( void ) -> bool {
+      try {
+        pmr::VectorList<int> vector_list( file );
+      } catch( const std::runtime_error& ) {
+        return true;
+      }
+      return false;
+    };
+
+    uint64_t slots = record.slots;
+    record.slots = uint64_t( 1 ) << 40;
+    assert( refused() );
+    record.slots = slots;
+
+    uint64_t size = record.size;
+    record.size = MAX_BLOCK_SIZE + 1;
+    assert( refused() );
+    record.size = size;
+
+    uint64_t first = order[0];
+    order[0] = list->num_blocks;
+    assert( refused() );
+    order[0] = first;
+
+    uint64_t blocks = list->num_blocks;
+    list->num_blocks = uint64_t( 1 ) << 40;
+    assert( refused() );
+    list->num_blocks = blocks;
+
+    ++list->capacity;
+    assert( refused() );
+    --list->capacity;
+
+    pmr::VectorList<int> vector_list( file );
+    assert( vector_list.size() > 0 );
+  }
+
+  std::filesystem::resize_file( path, 16 );
+
+  {
+    bool threw = false;
+    try {
+      Utils::MappedFile file( path, Utils::MapMode::Open );
+    } catch( const std::runtime_error& ) {
+      threw = true;
+    }
+    assert( threw );
+  }
+
+  std::filesystem::remove( path );
+}
@@ -0,0 +1,262 @@
+#include <cstdio>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "./test.hpp"
+#include "../vectorlist/vectorlist.hpp"
+
+template <> void vectorListSnapshotTests<int>( void )
+{
+  auto sumOf = []( VectorList<int>& vector_list ) -> int64_t {
+    int64_t sum = 0;
+    for( auto segment : vector_list.segments() ) {
+      segment.forEach( [&]( int& value ) -> void { sum += value; } );
+    }
+    return sum;
+  };
+
+  /*
+   * A restored container should hold the same elements at the same
+   * positions, answer to the same handles and keep its free slots
+   * */
+  {
+    FILE* file = std::tmpfile();
+    int fd = fileno( file );
+
+    VectorList<int> vector_list;
+    std::vector<Handle> handles;
+
+    for( int i = 0; i < 100000; ++i ) {
+      Handle handle = vector_list.emplaceHandle( i );
+      if( i % 1000 == 0 ) handles.push_back( handle );
+    }
+    vector_list.eraseIf( []( int value ) -> bool { return value % 3 == 1; } );
+    vector_list.snapshot( fd );
+
+    lseek( fd, 0, SEEK_SET );
+
+    VectorList<int> restored;
+    restored.emplace( -1 );
+    restored.restore( fd );
+
+    assert( restored.size() == vector_list.size() );
+    assert( restored.capacity() == vector_list.capacity() );
+    assert( sumOf( restored ) == sumOf( vector_list ) );
+
+    auto it = vector_list.begin();
+    for( auto copy = restored.begin(); copy != restored.end(); ++copy, ++it ) {
+      assert( *copy == *it );
+      assert( restored.indexOf( copy ) == vector_list.indexOf( it ) );
+    }
+    assert( it == vector_list.end() );
+
+    for( size_t i = 0; i < handles.size(); ++i ) {
+      int* value = restored.get( handles[i] );
+      int expected = int( i * 1000 );
+      assert( expected % 3 == 1 ? !value : value && *value == expected );
+    }
+
+    // filling every free slot needs no new block
+    size_t capacity = restored.capacity();
+    while( restored.size() < capacity ) {
+      restored.emplace( 0 );
+    }
+    assert( restored.capacity() == capacity );
+
+    std::fclose( file );
+  }
+
+  /*
+   * Trimmed blocks should stay retired, and snapshots written one
+   * after the other should be read back one after the other
+   * */
+  {
+    FILE* file = std::tmpfile();
+    int fd = fileno( file );
+
+    VectorList<int> first;
+    VectorList<int> second;
+
+    for( int i = 0; i < 50000; ++i ) {
+      first.emplace( i );
+      second.emplace( -i );
+    }
+    first.eraseIf( []( int value ) -> bool { return value < 40000; } );
+    assert( first.trim( 0 ) > 0 );
+
+    first.snapshot( fd );
+    second.snapshot( fd );
+    lseek( fd, 0, SEEK_SET );
+
+    VectorList<int> restored_first;
+    VectorList<int> restored_second;
+    restored_first.restore( fd );
+    restored_second.restore( fd );
+
+    assert( restored_first.capacity() == first.capacity() );
+    assert( restored_first.size() == 10000 && sumOf( restored_first ) == sumOf( first ) );
+    assert( restored_second.size() == 50000 && sumOf( restored_second ) == sumOf( second ) );
+    assert( *restored_first.begin() == 40000 );
+    assert( restored_first.indexOf( restored_first.begin() ) == first.indexOf( first.begin() ) );
+
+    // the restored container keeps growing as the original would
+    for( int i = 0; i < 50000; ++i ) {
+      restored_first.emplace( i );
+    }
+    assert( restored_first.size() == 60000 );
+
+    std::fclose( file );
+  }
+
+  /*
+   * A snapshot of another element type should be refused with the
+   * container left as it was, and one cut short should leave an
+   * empty container that still works
+   * */
+  {
+    FILE* file = std::tmpfile();
+    int fd = fileno( file );
+
+    struct Wide
+    {
+      int64_t values[4];
+    };
+
+    VectorList<Wide> wide;
+    wide.emplace( Wide{ { 1, 2, 3, 4 } } );
+    wide.snapshot( fd );
+    lseek( fd, 0, SEEK_SET );
+
+    VectorList<int> vector_list;
+    vector_list.emplace( 7 );
+
+    bool threw = false;
+    try {
+      vector_list.restore( fd );
+    } catch( const std::runtime_error& ) {
+      threw = true;
+    }
+    assert( threw );
+    assert( vector_list.size() == 1 && *vector_list.begin() == 7 );
+
+    VectorList<int> source;
+    for( int i = 0; i < 1000; ++i ) {
+      source.emplace( i );
+    }
+
+    assert( ftruncate( fd, 0 ) == 0 );
+    lseek( fd, 0, SEEK_SET );
+    source.snapshot( fd );
+
+    off_t bytes = lseek( fd, 0, SEEK_CUR );
+    assert( ftruncate( fd, bytes - 100 ) == 0 );
+    lseek( fd, 0, SEEK_SET );
+
+    threw = false;
+    try {
+      vector_list.restore( fd );
+    } catch( const std::runtime_error& ) {
+      threw = true;
+    }
+    assert( threw );
+    assert( vector_list.size() == 0 );
+
+    vector_list.emplace( 8 );
+    assert( vector_list.size() == 1 && *vector_list.begin() == 8 );
+
+    std::fclose( file );
+  }
+
+  /*
+   * A snapshot with a corrupt header, block record or bitmap should
+   * be refused before anything is allocated from it, a corrupt free
+   * chain should never be followed, and the container should still
+   * work afterwards
+   * */
+  {
+    FILE* file = std::tmpfile();
+    int fd = fileno( file );
+
+    VectorList<int> source;
+    for( int i = 0; i < 1000; ++i ) {
+      source.emplace( i );
+    }
+    source.snapshot( fd );
+
+    auto refused = [&]( VectorList<int>& vector_list ) -> bool {
+      lseek( fd, 0, SEEK_SET );
+      try {
+        vector_list.restore( fd );
+      } catch( const std::runtime_error& ) {
+        return true;
+      }
+      return false;
+    };
+
+    SnapshotHeader header;
+    assert( pread( fd, &header, sizeof( header ), 0 ) == sizeof( header ) );
+
+    SnapshotHeader corrupt = header;
+    corrupt.num_blocks = corrupt.num_ordered = uint64_t( 1 ) << 40;
+    assert( pwrite( fd, &corrupt, sizeof( corrupt ), 0 ) == sizeof( corrupt ) );
+
+    VectorList<int> vector_list;
+    vector_list.emplace( 7 );
+
+    assert( refused( vector_list ) );
+    assert( vector_list.size() == 1 && *vector_list.begin() == 7 );
+    assert( pwrite( fd, &header, sizeof( header ), 0 ) == sizeof( header ) );
+
+    SnapshotBlock record;
+    assert( pread( fd, &record, sizeof( record ), sizeof( header ) ) == sizeof( record ) );
+
+    SnapshotBlock bad = record;
+    bad.size = MAX_BLOCK_SIZE + 1;
+    assert( pwrite( fd, &bad, sizeof( bad ), sizeof( header ) ) == sizeof( bad ) );
+    assert( refused( vector_list ) );
+    assert( vector_list.size() == 0 );
+    assert( pwrite( fd, &record, sizeof( record ), sizeof( header ) ) == sizeof( record ) );
+
+    // a count that does not match the bitmaps
+    corrupt = header;
+    ++corrupt.live;
+    assert( pwrite( fd, &corrupt, sizeof( corrupt ), 0 ) == sizeof( corrupt ) );
+    assert( refused( vector_list ) );
+    assert( vector_list.size() == 0 );
+    assert( pwrite( fd, &header, sizeof( header ), 0 ) == sizeof( header ) );
+
+    // a bitmap marking slots past the end of its block
+    off_t bitmap = sizeof( header ) + sizeof( record ) + ( record.size + 2 ) * sizeof( Slot<int> );
+    uint64_t word;
+    assert( record.size % BITMAP_WORD_BITS != 0 );
+    assert( pread( fd, &word, sizeof( word ), bitmap ) == sizeof( word ) );
+    uint64_t past = word | uint64_t( 1 ) << record.size;
+    assert( pwrite( fd, &past, sizeof( past ), bitmap ) == sizeof( past ) );
+    assert( refused( vector_list ) );
+    assert( vector_list.size() == 0 );
+    assert( pwrite( fd, &word, sizeof( word ), bitmap ) == sizeof( word ) );
+
+    for( int i = 0; i < 100; ++i ) {
+      vector_list.emplace( i );
+    }
+    assert( vector_list.size() == 100 );
+
+    // a broken free chain is not followed, the free state is rebuilt
+    bad = record;
+    bad.free_head = Utils::makeSlotId( 1, record.size + 5 );
+    bad.num_free = record.size;
+    assert( pwrite( fd, &bad, sizeof( bad ), sizeof( header ) ) == sizeof( bad ) );
+    assert( !refused( vector_list ) );
+    assert( vector_list.size() == 1000 );
+
+    size_t capacity = vector_list.capacity();
+    vector_list.eraseIf( []( int value ) -> bool { return value % 2 == 0; } );
+    while( vector_list.size() < capacity ) {
+      vector_list.emplace( -1 );
+    }
+    assert( vector_list.capacity() == capacity );
+
+    std::fclose( file );
+  }
+}
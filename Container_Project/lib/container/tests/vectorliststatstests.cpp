@@ -0,0 +1,94 @@
+#include "./test.hpp"
+#include "../vectorlist/vectorlist.hpp"
+
+template <> void vectorListStatsTests<int>( void )
+{
+  typedef VectorList<int, Utils::BackoffPolicy, Utils::LinearGrowth<>, std::allocator<int>, Utils::CountingStats>
+    CountingList;
+
+  /*
+   * Without stats, iterators should carry nothing extra
+   * */
+  {
+    static_assert( sizeof( VectorList<int>::iterator ) == 3 * sizeof( void* ) );
+    static_assert( sizeof( CountingList::iterator ) == 4 * sizeof( void* ) );
+  }
+
+  /*
+   * Blocks, refills and the cached free slots of the
+   * calling thread should be counted
+   * */
+  {
+    CountingList vector_list;
+
+    for( int i = 0; i < 100; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    Utils::ContainerStats stats = vector_list.stats();
+    FreeCache* cache = vector_list.getCache();
+
+    assert( stats.blocks_pushed == vector_list.table_.size() );
+    assert( stats.refills > 0 );
+    assert( stats.flushes == 0 );
+    assert( stats.cached_free.size() == MAX_THREAD_CACHES );
+    assert( stats.cached_free[Utils::threadIndex()] == cache->count );
+    assert( stats.pool_free + cache->count + vector_list.size() == vector_list.capacity() );
+
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      vector_list.remove( it );
+    }
+    assert( vector_list.stats().flushes > 0 );
+  }
+
+  /*
+   * A full pass should take one step per element plus the one
+   * onto end(), and pass over every Free slot exactly once
+   * */
+  {
+    CountingList vector_list;
+
+    for( int i = 0; i < 1000; ++i ) {
+      vector_list.emplace( i );
+    }
+    vector_list.eraseIf( []( int value ) -> bool { return value % 3 != 0; } );
+
+    Utils::ContainerStats before = vector_list.stats();
+
+    size_t count = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      ++count;
+    }
+
+    Utils::ContainerStats after = vector_list.stats();
+
+    assert( after.iteration_steps - before.iteration_steps == count + 1 );
+    assert( after.slots_skipped - before.slots_skipped == vector_list.capacity() - vector_list.size() );
+  }
+
+  /*
+   * Counts made on other threads should be summed into the totals
+   * */
+  {
+    CountingList vector_list;
+    const int num_threads = 4;
+    std::vector<std::thread> threads;
+
+    for( int t = 0; t < num_threads; ++t ) {
+      threads.emplace_back( [&]( void ) -> void {
+        for( int i = 0; i < 1000; ++i ) {
+          vector_list.emplace( i );
+        }
+      } );
+    }
+
+    for( auto& thread : threads ) {
+      thread.join();
+    }
+
+    Utils::ContainerStats stats = vector_list.stats();
+
+    assert( stats.blocks_pushed == vector_list.table_.size() );
+    assert( stats.refills >= num_threads * 1000 / THREAD_CACHE_BATCH );
+  }
+}
@@ -0,0 +1,200 @@
+#include "./test.hpp"
+#include "../vectorlist/vectorlist.hpp"
+
+template <> void vectorListTrimTests<int>( void )
+{
+  /*
+   * Empty blocks should be unlinked by trim() without disturbing
+   * the Alive Elements around them, in either direction
+   * */
+  {
+    VectorList<int> vector_list;
+    const int size = 2000;
+
+    for( int i = 0; i < size; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    size_t num_blocks = vector_list.table_.size();
+    size_t capacity = vector_list.capacity();
+    assert( vector_list.emptyBlocks() == 0 );
+
+    // empty the first block and every other block after it
+    auto inBlock = [&]( Slot<int>* slot, size_t b ) -> bool {
+      const BlockInfo<int>& info = vector_list.table_[b];
+      return slot > info.slots && slot <= info.slots + info.size;
+    };
+
+    std::vector<int> expected;
+    size_t emptied = num_blocks / 2;
+
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      bool drop = false;
+
+      for( size_t b = 0; b + 1 < num_blocks; b += 2 ) {
+        drop = drop || inBlock( it.get(), b );
+      }
+
+      if( drop ) {
+        vector_list.remove( it );
+      } else {
+        expected.push_back( *it );
+      }
+    }
+
+    assert( vector_list.emptyBlocks() == emptied );
+
+    auto kept = vector_list.rend();
+    int kept_value = *kept;
+
+    assert( vector_list.trim( 1 ) == emptied );
+    assert( vector_list.emptyBlocks() == 0 );
+    assert( vector_list.capacity() < capacity );
+    assert( vector_list.spares_.size() == 1 );
+    assert( vector_list.size() == expected.size() );
+    assert( *kept == kept_value );
+
+    std::vector<int> forward;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      forward.push_back( *it );
+    }
+    assert( forward == expected );
+
+    std::vector<int> backward;
+    for( auto it = vector_list.rend(); it != vector_list.rbegin(); --it ) {
+      backward.push_back( *it );
+    }
+    std::reverse( backward.begin(), backward.end() );
+    assert( backward == expected );
+
+    // nothing left to trim
+    assert( vector_list.trim() == 0 );
+
+    // refilling should use the spare block before allocating new ones
+    size_t free_slots = vector_list.capacity() - vector_list.size();
+    for( size_t i = 0; i < free_slots + 1; ++i ) {
+      vector_list.emplace( -1 );
+    }
+    assert( vector_list.spares_.empty() );
+    assert( vector_list.table_.size() == num_blocks - emptied + 1 );
+
+    size_t count = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      ++count;
+    }
+    assert( count == vector_list.size() );
+    assert( count == expected.size() + free_slots + 1 );
+  }
+
+  /*
+   * shrinkToFit() should give every empty block back, the newest
+   * one too, but keep the smallest once all of them are empty
+   * */
+  {
+    VectorList<int> vector_list;
+
+    for( int i = 0; i < 1000; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      vector_list.remove( it );
+    }
+    assert( vector_list.size() == 0 );
+
+    size_t num_blocks = vector_list.table_.size();
+
+    assert( vector_list.shrinkToFit() == num_blocks - 1 );
+    assert( vector_list.spares_.empty() );
+    assert( vector_list.table_.size() == 1 );
+    assert( vector_list.capacity() == INITIAL_BLOCK_SIZE );
+    assert( vector_list.begin() == vector_list.end() );
+    assert( vector_list.rend() == vector_list.rbegin() );
+
+    for( int i = 0; i < 1000; ++i ) {
+      vector_list.emplace( i );
+    }
+    assert( vector_list.size() == 1000 );
+
+    size_t count = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      ++count;
+    }
+    assert( count == 1000 );
+  }
+
+  /*
+   * Emptying the newest block should let trim() drop it, and
+   * iteration and growth should carry on from the block before
+   * */
+  {
+    VectorList<int> vector_list;
+
+    for( int i = 0; i < 2000; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    size_t num_blocks = vector_list.table_.size();
+    size_t kept = vector_list.table_[num_blocks - 1].offset;
+
+    vector_list.erase( vector_list.iteratorAt( kept ), vector_list.end() );
+    assert( vector_list.size() == kept );
+
+    assert( vector_list.trim() == 1 );
+    assert( vector_list.table_.size() == num_blocks - 1 );
+    assert( vector_list.capacity() == kept );
+
+    size_t count = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      ++count;
+    }
+    assert( count == kept );
+
+    count = 0;
+    for( auto it = vector_list.rend(); it != vector_list.rbegin(); --it ) {
+      ++count;
+    }
+    assert( count == kept );
+
+    for( int i = 0; i < 1000; ++i ) {
+      vector_list.emplace( i );
+    }
+
+    count = 0;
+    for( auto it = vector_list.begin(); it != vector_list.end(); ++it ) {
+      ++count;
+    }
+    assert( count == kept + 1000 );
+  }
+
+  /*
+   * Spikes that are each followed by shrinkToFit() should leave the
+   * container as small as it was, and each spike should grow it
+   * back the same way, the block size starting over every time
+   * */
+  {
+    VectorList<int> vector_list;
+    size_t spike_capacity = 0;
+    size_t spike_blocks = 0;
+
+    for( int round = 0; round < 20; ++round ) {
+      for( int i = 0; i < 5000; ++i ) {
+        vector_list.emplace( i );
+      }
+
+      if( round == 0 ) {
+        spike_capacity = vector_list.capacity();
+        spike_blocks = vector_list.table_.size();
+      }
+      assert( vector_list.capacity() == spike_capacity );
+      assert( vector_list.table_.size() == spike_blocks );
+
+      vector_list.eraseIf( []( int ) -> bool { return true; } );
+      vector_list.shrinkToFit();
+
+      assert( vector_list.capacity() == INITIAL_BLOCK_SIZE );
+      assert( vector_list.table_.size() == 1 );
+      assert( vector_list.begin() == vector_list.end() );
+    }
+  }
+}
@@ -0,0 +1,310 @@
+#ifndef BLOCKTABLE_HPP_
+#define BLOCKTABLE_HPP_
+
+#include "../globals.hpp"
+
+/*
+ * Table of the BlockInfo of every block, in two views.
+ *
+ * A block keeps the id it was pushed with for as long as it lives,
+ * SlotIds and Handles name their block by id. Its position is its
+ * place in iteration order, which operator[] goes by. Retiring a
+ * block leaves its entry empty, and removeRetired() closes the gap
+ * it leaves in the order, so loops over positions only ever see
+ * live blocks.
+ *
+ * The ids of retired blocks are handed out again, so they stay
+ * below the largest number of blocks the container ever held at
+ * once. Each keeps the newest generation its last block reached,
+ * its floor, which the Slots of the next block under that id must
+ * start from so that Handles into the retired block stay stale.
+ *
+ * Entries and order are segmented arrays, segment s holding 2^s
+ * entries, and are never reallocated, so an entry can be read
+ * without a lock by any thread that learned about its block through
+ * an acquire (a published Boundary link or size()). Pushing is
+ * left to the caller to serialise
+ * */
+template <class T> class BlockTable
+{
+  private:
+  std::unique_ptr<BlockInfo<T>[]> entries_[MAX_BLOCK_SEGMENTS];
+  std::unique_ptr<size_t[]> order_[MAX_BLOCK_SEGMENTS];
+  std::atomic<size_t> ids_;
+  std::atomic<size_t> size_;
+
+  // ids free to reuse and the floor of every id, only used
+  // by the thread pushing and retiring
+  std::vector<size_t> free_ids_;
+  std::vector<uint32_t> floors_;
+
+  static size_t segmentOf( size_t index );
+  template <class U>
+  static U& entry( const std::unique_ptr<U[]>* segments, size_t index );
+  template <class U>
+  static U& make( std::unique_ptr<U[]>* segments, size_t index );
+
+  public:
+  BlockTable( void );
+
+  size_t push( const BlockInfo<T>& info );
+  void retire( size_t id, uint32_t floor );
+  void removeRetired( void );
+  void reorder( const std::vector<size_t>& ids );
+  void clear( void );
+
+  BlockInfo<T>& operator[]( size_t position );
+  const BlockInfo<T>& operator[]( size_t position ) const;
+  BlockInfo<T>& byId( size_t id );
+  const BlockInfo<T>& byId( size_t id ) const;
+  const BlockInfo<T>* published( size_t id ) const;
+
+  size_t size( void ) const;
+  size_t ids( void ) const;
+  size_t nextId( void ) const;
+  uint32_t floor( size_t id ) const;
+};
+
+template <class T>
+BlockTable<T>::BlockTable( void )
+    : ids_( 0 )
+    , size_( 0 )
+{
+}
+
+/*
+ * Entry i lives in segment floor(log2(i + 1))
+ * */
+template <class T>
+size_t BlockTable<T>::segmentOf( size_t index )
+{
+  return std::bit_width( index + 1 ) - 1;
+}
+
+/*
+ * Entry i of its segment. An index has at most 64 bits, so without
+ * the bound the compiler assumes segments up to 64 and warns about
+ * the ones past MAX_BLOCK_SEGMENTS
+ * */
+template <class T>
+template <class U>
+U& BlockTable<T>::entry( const std::unique_ptr<U[]>* segments, size_t index )
+{
+  size_t segment = segmentOf( index );
+
+  assert( segment < MAX_BLOCK_SEGMENTS );
+  if( segment >= MAX_BLOCK_SEGMENTS ) __builtin_unreachable();
+
+  return segments[segment][index + 1 - ( size_t( 1 ) << segment )];
+}
+
+/*
+ * Entry i, allocating its segment first if it has none yet
+ * */
+template <class T>
+template <class U>
+U& BlockTable<T>::make( std::unique_ptr<U[]>* segments, size_t index )
+{
+  size_t segment = segmentOf( index );
+
+  assert( segment < MAX_BLOCK_SEGMENTS );
+  if( segment >= MAX_BLOCK_SEGMENTS ) __builtin_unreachable();
+
+  if( !segments[segment] ) {
+    segments[segment].reset( new U[size_t( 1 ) << segment] );
+  }
+
+  return entry( segments, index );
+}
+
+/*
+ * Give a block the id nextId() tells and the last position, filling
+ * in both in its entry, and publish it. Returns its id.
+ *
+ * A thread holding a stale Handle may look at the entry of a reused
+ * id at any time, see published(), so its slots are stored last
+ * and the rest of the entry is only read once they are seen
+ * */
+template <class T>
+size_t BlockTable<T>::push( const BlockInfo<T>& info )
+{
+  size_t id = nextId();
+  size_t position = size_.load( std::memory_order_relaxed );
+
+  if( free_ids_.empty() ) {
+    floors_.push_back( 0 );
+  } else {
+    free_ids_.pop_back();
+  }
+
+  BlockInfo<T>& stored = make( entries_, id );
+  stored.locks = info.locks;
+  stored.occupancy = info.occupancy;
+  stored.summary = info.summary;
+  stored.live = info.live;
+  stored.generations = info.generations;
+  stored.size = info.size;
+  stored.offset = info.offset;
+  stored.node = info.node;
+  stored.id = id;
+  stored.position = position;
+  std::atomic_ref<Slot<T>*>( stored.slots ).store( info.slots, std::memory_order_release );
+
+  make( order_, position ) = id;
+
+  if( id == ids_.load( std::memory_order_relaxed ) ) ids_.store( id + 1, std::memory_order_release );
+  size_.store( position + 1, std::memory_order_release );
+  return id;
+}
+
+/*
+ * Empty the entry of a block that is being freed and set its id
+ * aside for reuse, with floor the newest generation any of its
+ * Slots reached. The block stays in the order until removeRetired(),
+ * and the ids of other blocks do not change, so their SlotIds stay
+ * valid. Only safe while no other thread reads the table
+ * */
+template <class T>
+void BlockTable<T>::retire( size_t id, uint32_t floor )
+{
+  BlockInfo<T>& info = byId( id );
+
+  info = BlockInfo<T>{};
+  info.id = id;
+
+  floors_[id] = std::max( floors_[id], floor );
+  free_ids_.push_back( id );
+}
+
+/*
+ * Take the retired blocks out of the order, the blocks that stay
+ * keeping their relative order. Only safe while no other thread
+ * reads the table
+ * */
+template <class T>
+void BlockTable<T>::removeRetired( void )
+{
+  size_t num_blocks = size_.load( std::memory_order_relaxed );
+  size_t kept = 0;
+
+  for( size_t position = 0; position < num_blocks; ++position ) {
+    size_t id = entry( order_, position );
+    BlockInfo<T>& info = byId( id );
+    if( !info.slots ) continue;
+
+    info.position = kept;
+    entry( order_, kept++ ) = id;
+  }
+
+  size_.store( kept, std::memory_order_release );
+}
+
+/*
+ * Make ids the iteration order, for a table whose blocks were all
+ * pushed by id and which takes the order of the container it copies.
+ * Only safe while no other thread reads the table
+ * */
+template <class T>
+void BlockTable<T>::reorder( const std::vector<size_t>& ids )
+{
+  for( size_t position = 0; position < ids.size(); ++position ) {
+    byId( ids[position] ).position = position;
+    make( order_, position ) = ids[position];
+  }
+
+  size_.store( ids.size(), std::memory_order_release );
+}
+
+/*
+ * Forget every entry, keeping the segments for the entries
+ * pushed next. Only safe while no other thread reads the table
+ * */
+template <class T>
+void BlockTable<T>::clear( void )
+{
+  free_ids_.clear();
+  floors_.clear();
+
+  ids_.store( 0, std::memory_order_release );
+  size_.store( 0, std::memory_order_release );
+}
+
+/*
+ * The block at a position in iteration order
+ * */
+template <class T>
+BlockInfo<T>& BlockTable<T>::operator[]( size_t position )
+{
+  return byId( entry( order_, position ) );
+}
+
+template <class T>
+const BlockInfo<T>& BlockTable<T>::operator[]( size_t position ) const
+{
+  return byId( entry( order_, position ) );
+}
+
+template <class T>
+BlockInfo<T>& BlockTable<T>::byId( size_t id )
+{
+  return entry( entries_, id );
+}
+
+template <class T>
+const BlockInfo<T>& BlockTable<T>::byId( size_t id ) const
+{
+  return entry( entries_, id );
+}
+
+/*
+ * The entry of a block id, or null if its block was retired. Unlike
+ * byId() this is safe to call with the id of a stale Handle while
+ * another thread may be pushing a block under that id
+ * */
+template <class T>
+const BlockInfo<T>* BlockTable<T>::published( size_t id ) const
+{
+  if( id >= ids() ) return nullptr;
+
+  BlockInfo<T>& info = entry( entries_, id );
+  return std::atomic_ref<Slot<T>*>( info.slots ).load( std::memory_order_acquire ) ? &info : nullptr;
+}
+
+/*
+ * Number of blocks in the order
+ * */
+template <class T>
+size_t BlockTable<T>::size( void ) const
+{
+  return size_.load( std::memory_order_acquire );
+}
+
+/*
+ * One more than the largest id handed out, those of
+ * retired blocks included
+ * */
+template <class T>
+size_t BlockTable<T>::ids( void ) const
+{
+  return ids_.load( std::memory_order_acquire );
+}
+
+/*
+ * The id the next block pushed gets, the last one retired if any
+ * */
+template <class T>
+size_t BlockTable<T>::nextId( void ) const
+{
+  return free_ids_.empty() ? ids_.load( std::memory_order_relaxed ) : free_ids_.back();
+}
+
+/*
+ * The generation the Slots of a block pushed under id start from
+ * */
+template <class T>
+uint32_t BlockTable<T>::floor( size_t id ) const
+{
+  return id < floors_.size() ? floors_[id] : 0;
+}
+
+#endif // BLOCKTABLE_HPP_
@@ -1,14 +1,182 @@
-template <class T> class VectorList;
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy> class VectorList;
 
-template <class T> VectorList<T>::VectorList( void )
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::VectorList( void )
+    : VectorList( Allocator() )
 {
-  blocks_.reserve( INITIAL_BLOCK_SIZE );
+}
 
-  first_ = nullptr;
-  last_ = nullptr;
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::VectorList( const Allocator& allocator )
+    : allocator_( allocator )
+    , blocks_( allocator )
+    , spares_( allocator )
+    , retired_( allocator )
+    , caches_( new FreeCache[MAX_THREAD_CACHES] )
+    , pools_( new FreePool[MAX_NUMA_NODES] )
+    , num_nodes_( std::clamp<size_t>( NodePolicy::nodes(), 1, MAX_NUMA_NODES ) )
+    , lock_( ATOMIC_FLAG_INIT )
+    , file_( nullptr )
+{
+  blocks_.reserve( INITIAL_BLOCK_SIZE );
 
-  size_ = 0;
   capacity_ = 0;
-  block_size_ = INITIAL_BLOCK_SIZE;
-  //  pushBlock();
+  empty_blocks_ = 0;
+  block_size_ = GrowthPolicy::initial( sizeof( Slot<T> ) );
+
+  for( size_t node = 0; node < num_nodes_; ++node ) {
+    pools_[node].node = node;
+  }
+
+  Utils::spinLockExecutor<LockPolicy>( [this]() -> void { grow( currentNode() ); }, lock_ );
+}
+
+/*
+ * Copy constructor.
+ *
+ * Blocks are copied one for one under the same ids and in the same
+ * order, so every SlotId means the same slot in both containers and
+ * the free lists and the free state of every block carry over unchanged.
+ * Trivially copyable elements are copied a whole block at a time
+ * with memcpy, others one Alive Slot at a time.
+ * No other thread may modify other while it is copied
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::VectorList( const VectorList& other )
+    : allocator_( std::allocator_traits<Allocator>::select_on_container_copy_construction( other.allocator_ ) )
+    , blocks_( allocator_ )
+    , spares_( allocator_ )
+    , retired_( allocator_ )
+    , caches_( new FreeCache[MAX_THREAD_CACHES] )
+    , pools_( new FreePool[MAX_NUMA_NODES] )
+    , num_nodes_( other.num_nodes_ )
+    , lock_( ATOMIC_FLAG_INIT )
+    , file_( nullptr )
+{
+  blocks_.reserve( std::max<size_t>( INITIAL_BLOCK_SIZE, other.blocks_.size() ) );
+
+  capacity_ = other.capacity_.load( std::memory_order_relaxed );
+  empty_blocks_ = other.empty_blocks_.load( std::memory_order_relaxed );
+  block_size_ = other.block_size_;
+
+  try {
+    for( size_t id = 0; id < other.table_.ids(); ++id ) {
+      copyBlock( other.table_.byId( id ), other.block_free_[id].fresh );
+    }
+  } catch( ... ) {
+    destroyAll();
+    throw;
+  }
+
+  std::vector<size_t> order( other.table_.size() );
+  for( size_t b = 0; b < order.size(); ++b ) {
+    order[b] = other.table_[b].id;
+  }
+
+  for( size_t id = 0; id < other.table_.ids(); ++id ) {
+    if( !other.table_.byId( id ).slots ) table_.retire( id, other.table_.floor( id ) );
+  }
+  table_.reorder( order );
+  linkBoundaries();
+
+  block_free_ = other.block_free_;
+
+  for( size_t node = 0; node < num_nodes_; ++node ) {
+    pools_[node].first = other.pools_[node].first;
+    pools_[node].count = other.pools_[node].count;
+    pools_[node].node = node;
+    pools_[node].live.store( other.pools_[node].live.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+  }
+
+  for( size_t i = 0; i < MAX_THREAD_CACHES; ++i ) {
+    caches_[i].head = other.caches_[i].head;
+    caches_[i].count = other.caches_[i].count;
+    caches_[i].node = other.caches_[i].node;
+    caches_[i].live.store( other.caches_[i].live.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+  }
+}
+
+/*
+ * Append a copy of a block of another container, retired or not,
+ * under the next id and with its Boundaries left unlinked. If copying a value throws, the values of this
+ * block copied so far are destroyed and the block is dropped.
+ * The slots from fresh on were never linked, so only the links of
+ * the Free slots before it are copied
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::copyBlock( const BlockInfo<T>& source, size_t fresh )
+{
+  if( !source.slots ) {
+    BlockInfo<T> info{};
+    info.offset = source.offset;
+
+    blocks_.emplace_back( Utils::emptySlotBlock<T>( allocator_ ) );
+    table_.push( info );
+    return;
+  }
+
+  size_t size = source.size;
+  SlotBlock<T, Allocator> block = Utils::allocateSlotBlock<T>( size, allocator_ );
+  BlockInfo<T> info = Utils::makeBlockInfo( block );
+  info.offset = source.offset;
+  info.node = source.node;
+
+  if constexpr( std::is_trivially_copyable_v<T> ) {
+    std::memcpy( static_cast<void*>( info.slots ), source.slots, ( size + 2 ) * sizeof( Slot<T> ) );
+  } else {
+    size_t i = 1;
+
+    try {
+      for( ; i <= size; ++i ) {
+        if( Utils::testBit( source.occupancy, i - 1 ) ) {
+          info.slots[i].emplace( source.slots[i].get() );
+        } else if( i < fresh ) {
+          info.slots[i].setNextSlot( source.slots[i].getNextSlot() );
+        }
+      }
+    } catch( ... ) {
+      while( --i > 0 ) {
+        if( Utils::testBit( source.occupancy, i - 1 ) ) info.slots[i].destroy();
+      }
+      throw;
+    }
+  }
+
+  info.slots[size + 1].setNext( nullptr );
+
+  size_t num_words = Utils::bitmapWords( size ) + Utils::summaryWords( size ) + 1;
+  for( size_t word = 0; word < num_words; ++word ) {
+    info.occupancy[word].store( source.occupancy[word].load( std::memory_order_relaxed ), std::memory_order_relaxed );
+  }
+
+  // the copy answers to the handles of the original
+  for( size_t i = 0; i < size + 2; ++i ) {
+    info.generations[i].store( source.generations[i].load( std::memory_order_relaxed ), std::memory_order_relaxed );
+  }
+
+  blocks_.emplace_back( std::move( block ) );
+  table_.push( info );
+}
+
+/*
+ * Blocks do not know which of their Slots are Alive,
+ * so the values are destroyed using the bitmaps.
+ * A container opened from a file is synced instead and its blocks
+ * stay in the file. A destructor cannot report a failed sync, so
+ * call sync() first to find out about one
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::~VectorList( void )
+{
+  if( file_ ) {
+    try {
+      sync();
+      if( !file_->readOnly() ) file_->setClean( true );
+    } catch( ... ) {
+    }
+    releaseBlocks();
+    return;
+  }
+
+  destroyAll();
 }
@@ -0,0 +1,266 @@
+#ifndef VECTORLISTITERATOR_HPP_
+#define VECTORLISTITERATOR_HPP_
+
+#include "../globals.hpp"
+#include "../element/slot.hpp"
+#include "../helpers/statspolicies.hpp"
+#include "./blocktable.hpp"
+
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy> class VectorList;
+
+/*
+ * Bidirectional iterator over the Alive Slots of a VectorList.
+ *
+ * An iterator only ever rests on an Alive Slot, on the head
+ * Boundary of the first block (rbegin) or on a tail Boundary (end).
+ * Tail Boundaries are re-read on every step so an iterator sitting
+ * at the end walks into blocks published after it got there.
+ * The next block is found by position, so an iterator to an Alive
+ * Element keeps working after trim() moves its block up the order.
+ *
+ * Alive Slots are found through the occupancy bitmap of each
+ * block, so runs of Free slots are skipped 64 at a time without
+ * touching the payloads themselves. The current block is tracked
+ * so per-block data can be found without a search.
+ *
+ * The iterator models std::bidirectional_iterator. Stepping is a
+ * direct call into the bitmap scan, there is no indirect dispatch,
+ * but loops that want a plain per-block loop should go through
+ * VectorList::segments() instead.
+ *
+ * With a counting StatsPolicy every step forward records
+ * how many Free slots it passed over
+ * */
+template <class T, class StatsPolicy = Utils::NoStats> class VectorListIterator
+{
+  private:
+  template <class U, class LockPolicy, class GrowthPolicy, class Allocator, class Stats, class Nodes> friend class VectorList;
+
+  const BlockTable<T>* table_;
+  const BlockInfo<T>* info_;
+  Slot<T>* slot_;
+  [[no_unique_address]] typename StatsPolicy::Sink stats_;
+
+  void findNextAlive( void );
+  void findPrevAlive( void );
+  bool atEnd( void ) const;
+
+  public:
+  typedef std::bidirectional_iterator_tag iterator_category;
+  typedef T value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef T* pointer;
+  typedef T& reference;
+
+  VectorListIterator( void );
+  VectorListIterator( const BlockTable<T>& table, const BlockInfo<T>& info, Slot<T>* slot,
+                      typename StatsPolicy::Sink stats = typename StatsPolicy::Sink() );
+
+  Slot<T>* get( void ) const;
+  ElementState getState( void ) const;
+
+  VectorListIterator& operator++( void );
+  VectorListIterator& operator--( void );
+  VectorListIterator operator++( int );
+  VectorListIterator operator--( int );
+  T& operator*( void ) const;
+  T* operator->( void ) const;
+  bool operator==( const VectorListIterator& other ) const;
+  bool operator!=( const VectorListIterator& other ) const;
+};
+
+/*
+ * A singular iterator that may only be assigned to or compared
+ * */
+template <class T, class StatsPolicy>
+VectorListIterator<T, StatsPolicy>::VectorListIterator( void )
+    : table_( nullptr )
+    , info_( nullptr )
+    , slot_( nullptr )
+{
+}
+
+template <class T, class StatsPolicy>
+VectorListIterator<T, StatsPolicy>::VectorListIterator( const BlockTable<T>& table, const BlockInfo<T>& info, Slot<T>* slot,
+                                                      typename StatsPolicy::Sink stats )
+    : table_( &table )
+    , info_( &info )
+    , slot_( slot )
+    , stats_( stats )
+{
+  assert( slot_ );
+}
+
+/*
+ * Step forward until an Alive Element or the
+ * last published tail Boundary is reached.
+ * Bit b of a bitmap stands for the Slot at index b + 1,
+ * and runs of removed Slots are skipped through the summary
+ * */
+template <class T, class StatsPolicy>
+void VectorListIterator<T, StatsPolicy>::findNextAlive( void )
+{
+  const BlockInfo<T>* info = info_;
+  size_t index = slot_ - info->slots;
+
+  // Free slots passed over, only kept with a counting StatsPolicy
+  size_t skipped = 0;
+  auto record = [&]( void ) -> void {
+    stats_.add( Utils::Stat::IterationSteps, 1 );
+    stats_.add( Utils::Stat::SlotsSkipped, skipped );
+  };
+
+  for( ;; ) {
+    if( index == info->size + 1 ) {
+      Slot<T>* next = info->slots[index].loadNext();
+
+      if( !next ) {
+        info_ = info;
+        slot_ = info->slots + index;
+        record();
+        return;
+      }
+
+      info = &( *table_ )[info->position + 1];
+      index = 0;
+    }
+
+    // first Alive Slot after index, i.e. the first set bit at or after index
+    size_t bit = Utils::findNextSet( info->occupancy, info->summary, info->size, index );
+
+    if( bit < info->size ) {
+      info_ = info;
+      slot_ = info->slots + bit + 1;
+      skipped += bit - index;
+      record();
+      return;
+    }
+
+    skipped += info->size - index;
+    index = info->size + 1;
+  }
+}
+
+/*
+ * Step backward until an Alive Element or the
+ * head Boundary of the first block is reached
+ * */
+template <class T, class StatsPolicy>
+void VectorListIterator<T, StatsPolicy>::findPrevAlive( void )
+{
+  const BlockInfo<T>* info = info_;
+  size_t index = slot_ - info->slots;
+
+  for( ;; ) {
+    if( index == 0 ) {
+      if( info->position == 0 ) {
+        info_ = info;
+        slot_ = info->slots;
+        return;
+      }
+
+      info = &( *table_ )[info->position - 1];
+      index = info->size + 1;
+    }
+
+    // last Alive Slot before index, i.e. the last set bit in [0, index - 1)
+    size_t limit = index - 1;
+    size_t bit = Utils::findPrevSet( info->occupancy, info->summary, limit );
+
+    if( bit < limit ) {
+      info_ = info;
+      slot_ = info->slots + bit + 1;
+      return;
+    }
+
+    index = 0;
+  }
+}
+
+/*
+ * An iterator resting on a tail Boundary is an end iterator,
+ * whichever block it belongs to. This keeps comparisons against
+ * end() exact while another thread is publishing a new block
+ * */
+template <class T, class StatsPolicy>
+bool VectorListIterator<T, StatsPolicy>::atEnd( void ) const
+{
+  return slot_ == info_->slots + info_->size + 1;
+}
+
+template <class T, class StatsPolicy>
+Slot<T>* VectorListIterator<T, StatsPolicy>::get( void ) const
+{
+  return slot_;
+}
+
+/*
+ * Slots do not store their state so it is
+ * derived from the position and the bitmap
+ * */
+template <class T, class StatsPolicy>
+ElementState VectorListIterator<T, StatsPolicy>::getState( void ) const
+{
+  size_t index = slot_ - info_->slots;
+
+  if( index == 0 || index == info_->size + 1 ) return ElementState::Boundary;
+  return Utils::testBit( info_->occupancy, index - 1 ) ? ElementState::Alive : ElementState::Free;
+}
+
+template <class T, class StatsPolicy>
+VectorListIterator<T, StatsPolicy>& VectorListIterator<T, StatsPolicy>::operator++( void )
+{
+  findNextAlive();
+  return *this;
+}
+
+template <class T, class StatsPolicy>
+VectorListIterator<T, StatsPolicy>& VectorListIterator<T, StatsPolicy>::operator--( void )
+{
+  findPrevAlive();
+  return *this;
+}
+
+template <class T, class StatsPolicy>
+VectorListIterator<T, StatsPolicy> VectorListIterator<T, StatsPolicy>::operator++( int )
+{
+  VectorListIterator copy = *this;
+  findNextAlive();
+  return copy;
+}
+
+template <class T, class StatsPolicy>
+VectorListIterator<T, StatsPolicy> VectorListIterator<T, StatsPolicy>::operator--( int )
+{
+  VectorListIterator copy = *this;
+  findPrevAlive();
+  return copy;
+}
+
+template <class T, class StatsPolicy>
+T& VectorListIterator<T, StatsPolicy>::operator*( void ) const
+{
+  assert( getState() == ElementState::Alive );
+  return slot_->get();
+}
+
+template <class T, class StatsPolicy>
+T* VectorListIterator<T, StatsPolicy>::operator->( void ) const
+{
+  return &slot_->get();
+}
+
+template <class T, class StatsPolicy>
+bool VectorListIterator<T, StatsPolicy>::operator==( const VectorListIterator& other ) const
+{
+  if( slot_ == other.slot_ ) return true;
+  return slot_ && other.slot_ && atEnd() && other.atEnd();
+}
+
+template <class T, class StatsPolicy>
+bool VectorListIterator<T, StatsPolicy>::operator!=( const VectorListIterator& other ) const
+{
+  return !( *this == other );
+}
+
+#endif // VECTORLISTITERATOR_HPP_
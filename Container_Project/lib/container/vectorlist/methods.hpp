@@ -1,52 +1,1972 @@
+#include <stdexcept>
+
 #include "../helpers/utils.hpp"
 
-template <class T> class VectorList;
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy> class VectorList;
 
 /*
- * Return a copy of the private size_ variable
+ * Sum the per-thread insertion counts. The result is
+ * only exact when no other thread is inserting or removing
  * */
-template <class T> size_t VectorList<T>::size( void ) const
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::size( void ) const
 {
-  return size_;
+  std::ptrdiff_t size = 0;
+
+  for( size_t node = 0; node < num_nodes_; ++node ) {
+    size += pools_[node].live.load( std::memory_order_relaxed );
+  }
+
+  for( size_t i = 0; i < MAX_THREAD_CACHES; ++i ) {
+    size += caches_[i].live.load( std::memory_order_relaxed );
+  }
+
+  return static_cast<size_t>( size );
 }
 
 /*
  * Return a copy of the private capacity_ variable
  * */
-template <class T> size_t VectorList<T>::capacity( void ) const
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::capacity( void ) const
 {
-  return capacity_;
+  return capacity_.load( std::memory_order_relaxed );
 }
 
 /*
- * Append a new Block to Blocks
+ * Return a copy of the allocator blocks are obtained from
  * */
-template <class T> void VectorList<T>::pushBlock( void )
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+Allocator VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::getAllocator( void ) const
 {
-  Block<T> block{ std::move( Utils::createBlock<T>( block_size_ ) ) };
+  return allocator_;
+}
 
-  auto functor = [&]() -> void {
-    if( !blocks_.empty() ) {
-      Block<T>& last_block = blocks_.back();
-      Element<T>* a = std::get<BlockPtr<T> >( last_block ).get() + std::get<size_t>( last_block ) + 1;
-      Element<T>* b = std::get<BlockPtr<T> >( block ).get();
+/*
+ * Number of NUMA nodes the container keeps apart
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::nodes( void ) const
+{
+  return num_nodes_;
+}
+
+/*
+ * The node the block of the element an iterator points to is for
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::nodeOf( const iterator& it ) const
+{
+  return it.info_->node;
+}
+
+/*
+ * Obtain the cache belonging to the calling thread or
+ * nullptr if there are more threads than caches
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+FreeCache* VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::getCache( void )
+{
+  size_t index = Utils::threadIndex();
+  return index < MAX_THREAD_CACHES ? caches_.get() + index : nullptr;
+}
+
+/*
+ * The node of the calling thread as told by the node policy
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::currentNode( void ) const
+{
+  return NodePolicy::currentNode() % num_nodes_;
+}
+
+/*
+ * Resolve a SlotId to its Slot
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+Slot<T>* VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::getSlot( SlotId slot )
+{
+  return table_.byId( Utils::slotBlock( slot ) ).slots + Utils::slotIndex( slot );
+}
+
+/*
+ * Append a new Block of size elements for node to Blocks. The node
+ * policy gets to bind the pages of its slots to node before they
+ * are touched, which for most of them is only once they are handed out
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::pushBlock( size_t size, size_t node )
+{
+  SlotBlock<T, Allocator> block = Utils::allocateSlotBlock<T>( size, allocator_ );
+
+  NodePolicy::bind( std::get<SlotPtr<T, Allocator> >( block ).get(), ( size + 2 ) * sizeof( Slot<T> ), node );
+  Utils::resetSlotBlock( block );
+
+  pushBlock( std::move( block ), node );
+}
+
+/*
+ * Append a Block for node to Blocks under the id the table hands
+ * out next and give it to the pool of that node with every slot
+ * fresh, so pushing does not walk the slots. When the id is reused,
+ * the generations of the Slots are raised to its floor first, so
+ * Handles into the block that had the id before never match an
+ * element of this one.
+ *
+ * The block is fully built and linked back to the current tail
+ * while still private. It is then published to iterating threads
+ * with a single CAS on the tail Boundary, so a reader either sees
+ * the old end or a completely linked block, never anything between.
+ * Must be called with lock_ held
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::pushBlock( SlotBlock<T, Allocator>&& block, size_t node )
+{
+  size_t size = std::get<size_t>( block );
+  size_t id = table_.nextId();
+
+  Slot<T>* slots = std::get<SlotPtr<T, Allocator> >( block ).get();
+  Slot<T>* tail = nullptr;
 
-      Utils::linkElements( a, b );
+  if( uint32_t floor = table_.floor( id ) ) {
+    std::atomic<uint32_t>* generations = std::get<GenerationArray<Allocator> >( block ).get();
+
+    for( size_t i = 0; i < size + 2; ++i ) {
+      if( generations[i].load( std::memory_order_relaxed ) < floor ) generations[i].store( floor, std::memory_order_relaxed );
     }
+  }
+
+  if( table_.size() ) {
+    const BlockInfo<T>& last = table_[table_.size() - 1];
+    tail = last.slots + last.size + 1;
+    slots[0].setNext( tail );
+  }
 
+  BlockInfo<T> info = Utils::makeBlockInfo( block );
+  info.offset = capacity_.load( std::memory_order_relaxed );
+  info.node = node;
+  table_.push( info );
+
+  if( tail ) {
+    bool published = tail->publishNext( nullptr, slots );
+    assert( published );
+    (void)published;
+  }
+
+  if( id >= block_free_.size() ) block_free_.resize( id + 1 );
+  block_free_[id] = BlockFree{};
+  listFree( id );
+  pools_[node].count += size;
+
+  if( id < blocks_.size() ) {
+    // blocks cannot be assigned when their allocator cannot
+    std::destroy_at( &blocks_[id] );
+    std::construct_at( &blocks_[id], std::move( block ) );
+  } else {
     blocks_.emplace_back( std::move( block ) );
+  }
+
+  capacity_.fetch_add( size, std::memory_order_relaxed );
+  empty_blocks_.fetch_add( 1, std::memory_order_relaxed );
+  stats_.add( Utils::Stat::BlocksPushed, 1 );
+}
+
+/*
+ * Append a block for node, one kept aside by trim() for the
+ * same node if there is one, else one of the size chosen by
+ * the growth policy. Must be called with lock_ held
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::grow( size_t node )
+{
+  for( size_t i = spares_.size(); i-- > 0; ) {
+    if( spare_nodes_[i] != node ) continue;
+
+    // blocks cannot be assigned when their allocator cannot,
+    // so the other spares are moved into a new list instead
+    SlotBlock<T, Allocator> block = std::move( spares_[i] );
+    SlotBlocks<T, Allocator> rest( allocator_ );
+
+    for( size_t j = 0; j < spares_.size(); ++j ) {
+      if( j != i ) rest.emplace_back( std::move( spares_[j] ) );
+    }
+    spares_.swap( rest );
+    spare_nodes_.erase( spare_nodes_.begin() + i );
+
+    Utils::resetSlotBlock( block );
+    pushBlock( std::move( block ), node );
+    return;
+  }
+
+  pushBlock( block_size_, node );
+  block_size_ = GrowthPolicy::next( block_size_, sizeof( Slot<T> ) );
+}
+
+/*
+ * Make room for at least n elements in total, allocating the
+ * missing capacity as blocks as large as the growth policy allows
+ * rather than growing block by block. The sizes of the blocks
+ * that later growth adds are not affected
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::reserve( size_t n )
+{
+  size_t node = currentNode();
+
+  auto functor = [&]() -> void {
+    size_t capacity = capacity_.load( std::memory_order_relaxed );
+
+    while( capacity < n ) {
+      size_t size = Utils::clampBlockSize( n - capacity, GrowthPolicy::minSize(), GrowthPolicy::maxSize() );
+      pushBlock( size, node );
+      capacity += size;
+    }
+  };
+
+  Utils::spinLockExecutor<LockPolicy>( functor, lock_ );
+}
+
+/*
+ * Destroy every Alive value, found through the bitmaps. Values
+ * that are trivially destructible are simply forgotten
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::destroyAll( void )
+{
+  if constexpr( std::is_trivially_destructible_v<T> ) return;
+
+  for( size_t b = 0; b < table_.size(); ++b ) {
+    const BlockInfo<T>& info = table_[b];
+    size_t num_words = Utils::bitmapWords( info.size );
+
+    for( size_t word = 0; word < num_words; ++word ) {
+      uint64_t bits = info.occupancy[word].load( std::memory_order_relaxed );
+
+      while( bits ) {
+        info.slots[word * BITMAP_WORD_BITS + std::countr_zero( bits ) + 1].destroy();
+        bits &= bits - 1;
+      }
+    }
+  }
+}
+
+/*
+ * Remove every element while keeping all blocks. Only the bitmap
+ * words their summaries mark are reset, and every slot of every
+ * block is made fresh again, so the slots themselves are not
+ * written: clearing takes time in the number of blocks and occupied
+ * words, not elements. For trivially destructible T no value is visited.
+ * No other thread may use the container while it is cleared
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::clear( void )
+{
+  auto functor = [&]() -> void {
+    destroyAll();
+
+    for( size_t b = 0; b < table_.size(); ++b ) {
+      const BlockInfo<T>& info = table_[b];
+
+      for( size_t word = 0; word < Utils::summaryWords( info.size ); ++word ) {
+        uint64_t marked = info.summary[word].load( std::memory_order_relaxed );
+
+        for( ; marked; marked &= marked - 1 ) {
+          info.occupancy[word * BITMAP_WORD_BITS + std::countr_zero( marked )].store( 0, std::memory_order_relaxed );
+        }
+        info.summary[word].store( 0, std::memory_order_relaxed );
+      }
+      info.live->store( 0, std::memory_order_relaxed );
+
+      block_free_[info.id] = BlockFree{};
+    }
+
+    for( size_t i = 0; i < MAX_THREAD_CACHES; ++i ) {
+      caches_[i].head = NULL_SLOT;
+      caches_[i].count = 0;
+      caches_[i].live.store( 0, std::memory_order_relaxed );
+    }
+
+    for( size_t node = 0; node < num_nodes_; ++node ) {
+      pools_[node].live.store( 0, std::memory_order_relaxed );
+    }
+    relistFree();
+    empty_blocks_.store( table_.size(), std::memory_order_relaxed );
+  };
+
+  Utils::spinLockExecutor<LockPolicy>( functor, lock_ );
+}
+
+/*
+ * Give the Free slots of every thread cache back to their blocks,
+ * and gather every live count into that of the first pool, which
+ * is returned. Takes time in the number of cached slots only.
+ * Must be called with lock_ held while no other thread uses the
+ * container
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+std::ptrdiff_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::drainCaches( void )
+{
+  std::ptrdiff_t live = 0;
+
+  for( size_t i = 0; i < MAX_THREAD_CACHES; ++i ) {
+    FreeCache& cache = caches_[i];
+
+    if( cache.head != NULL_SLOT ) {
+      giveSlots( cache.head );
+      cache.head = NULL_SLOT;
+      cache.count = 0;
+    }
+
+    live += cache.live.exchange( 0, std::memory_order_relaxed );
+  }
+
+  for( size_t node = 0; node < num_nodes_; ++node ) {
+    live += pools_[node].live.exchange( 0, std::memory_order_relaxed );
+  }
+  pools_[0].live.store( live, std::memory_order_relaxed );
+
+  return live;
+}
+
+/*
+ * Free every block, spares included, without destroying any value,
+ * and empty the caches and pools. The container is left with no
+ * block at all, to be given new ones. Must be called with lock_
+ * held while no other thread uses the container
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::resetBlocks( void )
+{
+  // swapped out rather than cleared, blocks cannot be assigned
+  // when their allocator cannot
+  SlotBlocks<T, Allocator> blocks( allocator_ );
+  SlotBlocks<T, Allocator> spares( allocator_ );
+
+  blocks_.swap( blocks );
+  spares_.swap( spares );
+  spare_nodes_.clear();
+
+  // the state last synced to a file still names its blocks
+  if( file_ ) {
+    for( SlotBlock<T, Allocator>& block : blocks ) {
+      retired_.emplace_back( std::move( block ) );
+    }
+  }
+
+  table_.clear();
+  block_free_.clear();
+
+  blocks_.reserve( INITIAL_BLOCK_SIZE );
+
+  for( size_t i = 0; i < MAX_THREAD_CACHES; ++i ) {
+    caches_[i].head = NULL_SLOT;
+    caches_[i].count = 0;
+    caches_[i].live.store( 0, std::memory_order_relaxed );
+  }
+
+  for( size_t node = 0; node < num_nodes_; ++node ) {
+    pools_[node].first = NULL_BLOCK;
+    pools_[node].count = 0;
+    pools_[node].live.store( 0, std::memory_order_relaxed );
+  }
+
+  capacity_ = 0;
+  empty_blocks_ = 0;
+}
+
+/*
+ * Number of blocks currently holding no Alive Elements
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::emptyBlocks( void ) const
+{
+  return empty_blocks_.load( std::memory_order_relaxed );
+}
+
+/*
+ * Drop the Free slots of the marked blocks from a free list
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::unlinkFree( FreeCache& cache, const std::vector<bool>& dropped )
+{
+  Slot<T>* prev = nullptr;
+
+  for( SlotId slot = cache.head; slot != NULL_SLOT; ) {
+    Slot<T>* current = getSlot( slot );
+    SlotId next = current->getNextSlot();
+
+    if( dropped[Utils::slotBlock( slot )] ) {
+      --cache.count;
+    } else {
+      if( prev ) {
+        prev->setNextSlot( slot );
+      } else {
+        cache.head = slot;
+      }
+      prev = current;
+    }
+
+    slot = next;
+  }
+
+  if( prev ) {
+    prev->setNextSlot( NULL_SLOT );
+  } else {
+    cache.head = NULL_SLOT;
+  }
+}
+
+/*
+ * Number of Free slots a block holds itself, those
+ * in thread caches not counted
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::freeIn( size_t id ) const
+{
+  const BlockFree& free = block_free_[id];
+  return free.count + table_.byId( id ).size + 1 - free.fresh;
+}
+
+/*
+ * Put a block in front of the blocks of its node that hold
+ * Free slots, or take it out of them. Must be called with lock_ held
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::listFree( size_t id )
+{
+  BlockFree& free = block_free_[id];
+  FreePool& pool = pools_[table_.byId( id ).node];
+
+  free.prev = NULL_BLOCK;
+  free.next = pool.first;
+  if( pool.first != NULL_BLOCK ) block_free_[pool.first].prev = id;
+  pool.first = id;
+}
+
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::unlistFree( size_t id )
+{
+  BlockFree& free = block_free_[id];
+
+  if( free.prev != NULL_BLOCK ) {
+    block_free_[free.prev].next = free.next;
+  } else {
+    pools_[table_.byId( id ).node].first = free.next;
+  }
+  if( free.next != NULL_BLOCK ) block_free_[free.next].prev = free.prev;
+}
+
+/*
+ * Rebuild the lists of blocks holding Free slots and the pool
+ * counts from the free state of the blocks, for free states that
+ * were set directly. Earlier blocks in iteration order come first.
+ * Must be called with lock_ held
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::relistFree( void )
+{
+  for( size_t node = 0; node < num_nodes_; ++node ) {
+    pools_[node].first = NULL_BLOCK;
+    pools_[node].count = 0;
+  }
+
+  for( size_t b = table_.size(); b-- > 0; ) {
+    const BlockInfo<T>& info = table_[b];
+    size_t free = freeIn( info.id );
+    if( !free ) continue;
+
+    listFree( info.id );
+    pools_[info.node].count += free;
+  }
+}
+
+/*
+ * Take one Free slot a block holds, one given back to it before
+ * any fresh one. The block must hold one. Must be called with lock_ held
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+SlotId VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::popFree( size_t id )
+{
+  BlockFree& free = block_free_[id];
+  SlotId slot;
+
+  if( free.head != NULL_SLOT ) {
+    slot = free.head;
+    free.head = getSlot( slot )->getNextSlot();
+    --free.count;
+  } else {
+    slot = Utils::makeSlotId( id, free.fresh++ );
+  }
+
+  --pools_[table_.byId( id ).node].count;
+  if( !freeIn( id ) ) unlistFree( id );
+
+  return slot;
+}
+
+/*
+ * Detach a chain of n Free slots from the pool of node, ending in
+ * NULL_SLOT, and set tail to its last slot. The pool must hold n.
+ * The blocks are used up one after the other, each handing out its
+ * fresh slots first as one run, which is only linked now. Takes
+ * time in n. Must be called with lock_ held
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+SlotId VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::takeSlots( size_t node, size_t n, Slot<T>*& tail )
+{
+  FreePool& pool = pools_[node];
+  SlotId head = NULL_SLOT;
+
+  assert( n && pool.count >= n );
+  tail = nullptr;
+
+  auto append = [&]( SlotId slot, Slot<T>* last ) -> void {
+    if( tail ) {
+      tail->setNextSlot( slot );
+    } else {
+      head = slot;
+    }
+    tail = last;
+  };
+
+  while( n ) {
+    size_t id = pool.first;
+    BlockFree& free = block_free_[id];
+    const BlockInfo<T>& info = table_.byId( id );
+    size_t fresh = std::min( n, info.size + 1 - free.fresh );
+
+    if( fresh ) {
+      Utils::setInternalSlotList( info.slots + free.fresh, fresh, id, free.fresh, NULL_SLOT );
+      append( Utils::makeSlotId( id, free.fresh ), info.slots + free.fresh + fresh - 1 );
+
+      free.fresh += fresh;
+      pool.count -= fresh;
+      n -= fresh;
+      if( !freeIn( id ) ) unlistFree( id );
+    }
+
+    for( ; n && free.head != NULL_SLOT; --n ) {
+      SlotId slot = popFree( id );
+      append( slot, getSlot( slot ) );
+    }
+  }
+
+  tail->setNextSlot( NULL_SLOT );
+  return head;
+}
+
+/*
+ * Give a Free slot back to the block it belongs to.
+ * Must be called with lock_ held
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::giveSlot( SlotId slot )
+{
+  size_t id = Utils::slotBlock( slot );
+  BlockFree& free = block_free_[id];
+
+  if( !freeIn( id ) ) listFree( id );
+
+  getSlot( slot )->setNextSlot( free.head );
+  free.head = slot;
+  ++free.count;
+  ++pools_[table_.byId( id ).node].count;
+}
+
+/*
+ * Give every slot of a chain ending in NULL_SLOT back to the
+ * block it belongs to. Must be called with lock_ held
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::giveSlots( SlotId head )
+{
+  for( SlotId slot = head; slot != NULL_SLOT; ) {
+    SlotId next = getSlot( slot )->getNextSlot();
+    giveSlot( slot );
+    slot = next;
+  }
+}
+
+/*
+ * Link the head and tail Boundaries of the blocks in iteration
+ * order, the tail Boundary of the last block ending the container.
+ * Only safe while no other thread iterates
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::linkBoundaries( void )
+{
+  Slot<T>* tail = nullptr;
+
+  for( size_t b = 0; b < table_.size(); ++b ) {
+    const BlockInfo<T>& info = table_[b];
+
+    info.slots[0].setNext( tail );
+    if( tail ) tail->setNext( info.slots );
+    tail = info.slots + info.size + 1;
+  }
+
+  if( tail ) tail->setNext( nullptr );
+}
+
+/*
+ * Unlink every block that holds no Alive Elements and relink the
+ * Boundaries of the blocks around them. Once every block is empty
+ * the smallest one stays, so there always is a block to end the
+ * container. Up to keep of the unlinked blocks are set aside for
+ * growth to reuse and the rest are given back to the allocator.
+ * The unlinked blocks leave the iteration order, so later work
+ * does not grow with the number of blocks ever pushed, and growth
+ * carries on from the block size it would have reached with only
+ * the blocks that are left.
+ * Returns the number of blocks unlinked.
+ *
+ * Iterators to Alive Elements and their SlotIds stay valid, end
+ * iterators do not. No other thread may use the container while
+ * it is trimmed. emptyBlocks() is cheap, so owners can trim once
+ * it passes a threshold at a point where the container is quiet
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::trim( size_t keep )
+{
+  auto functor = [&]() -> size_t {
+    size_t num_blocks = table_.size();
+    std::vector<bool> dropped( table_.ids(), false );
+    size_t num_dropped = 0;
+    size_t smallest = 0;
+
+    for( size_t b = 0; b < num_blocks; ++b ) {
+      const BlockInfo<T>& info = table_[b];
+
+      if( info.size < table_[smallest].size ) smallest = b;
+      if( info.live->load( std::memory_order_relaxed ) == 0 ) {
+        dropped[info.id] = true;
+        ++num_dropped;
+      }
+    }
 
-    capacity_ += block_size_;
-    block_size_ += BLOCK_INCREMENT;
+    if( num_dropped == num_blocks ) {
+      dropped[table_[smallest].id] = false;
+      --num_dropped;
+    }
+
+    while( spares_.size() > keep ) {
+      spares_.pop_back();
+      spare_nodes_.pop_back();
+    }
+    if( !num_dropped ) return 0;
+
+    for( size_t i = 0; i < MAX_THREAD_CACHES; ++i ) {
+      unlinkFree( caches_[i], dropped );
+    }
+
+    std::vector<size_t> ids;
+    for( size_t b = 0; b < num_blocks; ++b ) {
+      if( dropped[table_[b].id] ) ids.push_back( table_[b].id );
+    }
+    dropBlocks( ids, keep );
+
+    return num_dropped;
   };
 
-  //  Utils::spinLockExecutor( functor );
-  //
-  //  // append to free list
-  //
-  //  std::thread::id curr_id = std::this_thread::get_id();
-  //
-  //  if ( free_lists_.find( curr_id ) != free_lists_.end() ) {
-  //
-  //  }
+  return Utils::spinLockExecutor<LockPolicy>( functor, lock_ );
+}
+
+/*
+ * Unlink the given empty blocks, whose Free slots must not be in
+ * any thread cache any more, setting up to keep of them aside as spares
+ * and giving the rest back to the allocator. The blocks of a
+ * container in a file are neither kept nor freed but retired until
+ * the next sync(), see recover(). Besides the blocks
+ * themselves this only renumbers the blocks that stay and relinks
+ * their Boundaries. Must be called with lock_ held while no other
+ * thread uses the container
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::dropBlocks( const std::vector<size_t>& ids, size_t keep )
+{
+  for( size_t id : ids ) {
+    const BlockInfo<T>& info = table_.byId( id );
+    size_t node = info.node;
+
+    assert( info.live->load( std::memory_order_relaxed ) == 0 );
+
+    if( size_t free = freeIn( id ) ) {
+      pools_[node].count -= free;
+      unlistFree( id );
+    }
+
+    capacity_.fetch_sub( info.size, std::memory_order_relaxed );
+    table_.retire( id, Utils::maxGeneration( info ) );
+
+    SlotBlock<T, Allocator>& block = blocks_[id];
+    if( file_ ) {
+      retired_.emplace_back( std::move( block ) );
+    } else if( spares_.size() < keep ) {
+      spares_.emplace_back( std::move( block ) );
+      spare_nodes_.push_back( node );
+    } else {
+      std::get<SlotPtr<T, Allocator> >( block ).reset();
+      std::get<LockArray<Allocator> >( block ).reset();
+      std::get<BitmapArray<Allocator> >( block ).reset();
+      std::get<GenerationArray<Allocator> >( block ).reset();
+    }
+    std::get<size_t>( block ) = 0;
+  }
+
+  table_.removeRetired();
+  linkBoundaries();
+
+  // the slots of the blocks that stay are numbered without gaps
+  size_t offset = 0;
+  size_t size = GrowthPolicy::initial( sizeof( Slot<T> ) );
+
+  for( size_t b = 0; b < table_.size(); ++b ) {
+    table_[b].offset = offset;
+    offset += table_[b].size;
+    size = GrowthPolicy::next( size, sizeof( Slot<T> ) );
+  }
+  block_size_ = std::min( block_size_, size );
+
+  empty_blocks_.fetch_sub( ids.size(), std::memory_order_relaxed );
+}
+
+/*
+ * Trim every empty block and give all of them back to the allocator
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::shrinkToFit( void )
+{
+  return trim( 0 );
+}
+
+/*
+ * Move up to budget Alive Elements out of the sparsest blocks into
+ * the holes of the densest blocks of the same node, then drop the
+ * blocks this empties. Called a little at a time, e.g. once per
+ * tick, it packs a container thinned out by removals without one
+ * long pause. Returns the number of elements moved, 0 once there
+ * is nothing left to gain.
+ *
+ * The budget bounds the moves, not the whole call. Before it moves
+ * anything, every call reads the live count of every block and puts
+ * the blocks of each node in two heaps, one sparsest first and one
+ * densest first. That setup takes time and memory linear in the
+ * number of blocks, even for a budget of 1, so a call costs at least
+ * O(blocks). The sparse and dense order is rebuilt each time, as
+ * insertions and removals between calls change it. After the setup,
+ * the work depends only on the elements moved and on the blocks they
+ * come from and go to. Each block taken costs one heap pop, holes
+ * are taken from the blocks that hold them, the slots moved out of
+ * go back to theirs, and only the sources emptied are dropped. A
+ * source with Free slots still in a thread cache stays until the
+ * next trim().
+ *
+ * relocated( from, to ) is called with the old and the new Handle
+ * of every element moved, with the container lock held, so it must
+ * not use the container. Handles and iterators to moved elements
+ * are no longer valid. If moving an element throws, the elements
+ * moved before it stay moved.
+ * No other thread may use the container while it is compacted
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class F>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::compact( size_t budget, F relocated )
+{
+  auto functor = [&]() -> size_t {
+    size_t num_blocks = table_.size();
+    size_t moved = 0;
+    std::vector<size_t> emptied;
+    std::vector<bool> taken( table_.ids(), false );
+
+    auto liveOf = [&]( size_t b ) -> size_t { return table_.byId( b ).live->load( std::memory_order_relaxed ); };
+
+    // a is denser than b, comparing live / size without dividing
+    auto denser = [&]( size_t a, size_t b ) -> bool { return liveOf( a ) * table_.byId( b ).size > liveOf( b ) * table_.byId( a ).size; };
+    auto sparser = [&]( size_t a, size_t b ) -> bool { return denser( b, a ); };
+
+    for( size_t node = 0; node < num_nodes_ && moved < budget; ++node ) {
+      std::vector<size_t> sparse;
+
+      for( size_t b = 0; b < num_blocks; ++b ) {
+        // blocks whose ids a Handle cannot hold are left where they are
+        if( table_[b].node == node && table_[b].id < ( size_t( 1 ) << HANDLE_BLOCK_BITS ) ) sparse.push_back( table_[b].id );
+      }
+
+      // the top of sparse is the sparsest block, that of dense the densest
+      std::vector<size_t> dense( sparse );
+      std::make_heap( sparse.begin(), sparse.end(), denser );
+      std::make_heap( dense.begin(), dense.end(), sparser );
+
+      auto pop = [&]( std::vector<size_t>& heap, auto& before ) -> size_t {
+        std::pop_heap( heap.begin(), heap.end(), before );
+        size_t b = heap.back();
+        heap.pop_back();
+        return b;
+      };
+
+      // plan the moves: sources are taken from the sparse end and
+      // emptied into targets taken from the dense end, until the two meet
+      std::vector<std::pair<size_t, size_t> > sources;
+      std::vector<size_t> targets;
+      size_t left = 0, room = 0, planned = 0;
+
+      while( moved + planned < budget ) {
+        if( !left ) {
+          if( sparse.empty() ) break;
+
+          size_t b = pop( sparse, denser );
+          if( taken[b] ) break;
+          taken[b] = true;
+
+          left = liveOf( b );
+          if( left ) sources.emplace_back( b, 0 );
+        } else if( !room ) {
+          if( dense.empty() ) break;
+
+          size_t b = pop( dense, sparser );
+          if( taken[b] ) break;
+          taken[b] = true;
+
+          // only the holes the block holds itself, not those in thread caches
+          room = freeIn( b );
+          if( room ) targets.push_back( b );
+        } else {
+          size_t n = std::min( { left, room, budget - moved - planned } );
+          sources.back().second += n;
+          left -= n;
+          room -= n;
+          planned += n;
+        }
+      }
+
+      if( !planned ) continue;
+
+      size_t target = 0;
+
+      // the next Free slot of the targets, moving on to the next target once one is full
+      auto nextHole = [&]() -> size_t {
+        while( !freeIn( targets[target] ) ) {
+          ++target;
+        }
+        return Utils::slotIndex( popFree( targets[target] ) );
+      };
+
+      for( auto [b, n] : sources ) {
+        const BlockInfo<T>& source = table_.byId( b );
+
+        for( size_t word = 0; n && word < Utils::bitmapWords( source.size ); ++word ) {
+          uint64_t bits = source.occupancy[word].load( std::memory_order_relaxed );
+
+          for( ; n && bits; bits &= bits - 1, --n ) {
+            size_t from = word * BITMAP_WORD_BITS + std::countr_zero( bits ) + 1;
+            size_t to = nextHole();
+            const BlockInfo<T>& info = table_.byId( targets[target] );
+
+            try {
+              info.slots[to].emplace( std::move( source.slots[from].get() ) );
+            } catch( ... ) {
+              giveSlot( Utils::makeSlotId( targets[target], to ) );
+              throw;
+            }
+            Utils::nextGeneration( info.generations[to] );
+            Utils::setOccupied( info.occupancy, info.summary, to - 1 );
+            if( info.live->fetch_add( 1, std::memory_order_relaxed ) == 0 ) empty_blocks_.fetch_sub( 1, std::memory_order_relaxed );
+
+            source.slots[from].destroy();
+            Utils::clearOccupied( source.occupancy, source.summary, from - 1 );
+            if( source.live->fetch_sub( 1, std::memory_order_relaxed ) == 1 ) empty_blocks_.fetch_add( 1, std::memory_order_relaxed );
+
+            giveSlot( Utils::makeSlotId( b, from ) );
+            ++moved;
+
+            relocated( Utils::makeHandle( b, from, source.generations[from].load( std::memory_order_relaxed ) ),
+                       Utils::makeHandle( targets[target], to, info.generations[to].load( std::memory_order_relaxed ) ) );
+          }
+        }
+
+        // a source is dropped once every one of its slots is back
+        if( !liveOf( b ) && freeIn( b ) == source.size ) emptied.push_back( b );
+      }
+    }
+
+    if( !emptied.empty() ) dropBlocks( emptied, TRIM_RESERVE_BLOCKS );
+
+    stats_.add( Utils::Stat::Relocations, moved );
+    return moved;
+  };
+
+  return Utils::spinLockExecutor<LockPolicy>( functor, lock_ );
+}
+
+/*
+ * Compact without being told where elements went, for
+ * containers whose elements are not reached through Handles
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::compact( size_t budget )
+{
+  return compact( budget, []( Handle, Handle ) -> void {} );
+}
+
+/*
+ * Move a batch of slots from the pool of the calling thread's
+ * node into an empty thread cache, growing the container on that
+ * node if the pool is dry. The cache is for that node from then on
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::refill( FreeCache& cache )
+{
+  assert( cache.head == NULL_SLOT );
+
+  size_t node = currentNode();
+  FreePool& pool = pools_[node];
+
+  auto functor = [&]() -> void {
+    if( !pool.count ) grow( node );
+
+    size_t batch = std::min<size_t>( THREAD_CACHE_BATCH, pool.count );
+    Slot<T>* tail;
+
+    cache.head = takeSlots( node, batch, tail );
+    cache.count = batch;
+    cache.node = node;
+  };
+
+  Utils::spinLockExecutor<LockPolicy>( functor, lock_ );
+  stats_.add( Utils::Stat::Refills, 1 );
+}
+
+/*
+ * Hand a batch of slots from an overfull thread cache
+ * back to the blocks of the pool of its node
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::flush( FreeCache& cache )
+{
+  assert( cache.count > THREAD_CACHE_BATCH );
+
+  SlotId head = cache.head;
+  Slot<T>* tail = getSlot( head );
+
+  for( size_t i = 1; i < THREAD_CACHE_BATCH; ++i ) {
+    tail = getSlot( tail->getNextSlot() );
+  }
+
+  cache.head = tail->getNextSlot();
+  cache.count -= THREAD_CACHE_BATCH;
+  tail->setNextSlot( NULL_SLOT );
+
+  Utils::spinLockExecutor<LockPolicy>( [&]() -> void { giveSlots( head ); }, lock_ );
+  stats_.add( Utils::Stat::Flushes, 1 );
+}
+
+/*
+ * Construct an element in a Free slot taken off every free list
+ * and mark it Alive in the occupancy bitmap of its block
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class... Args>
+typename VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::iterator VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::emplaceAt( SlotId slot, Args&&... args )
+{
+  size_t index = Utils::slotIndex( slot );
+  const BlockInfo<T>& info = table_.byId( Utils::slotBlock( slot ) );
+
+  info.slots[index].emplace( std::forward<Args>( args )... );
+  Utils::nextGeneration( info.generations[index] );
+  Utils::setOccupied( info.occupancy, info.summary, index - 1 );
+  if( info.live->fetch_add( 1, std::memory_order_relaxed ) == 0 ) empty_blocks_.fetch_sub( 1, std::memory_order_relaxed );
+
+  return iterator( table_, info, info.slots + index, &stats_ );
+}
+
+/*
+ * Construct an element in the first slot of a non-empty cache.
+ * If the constructor of T throws, the cache is left untouched
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class... Args>
+typename VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::iterator VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::emplaceFrom( FreeCache& cache, Args&&... args )
+{
+  SlotId next = getSlot( cache.head )->getNextSlot();
+  iterator it = emplaceAt( cache.head, std::forward<Args>( args )... );
+
+  cache.head = next;
+  --cache.count;
+  cache.live.store( cache.live.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+
+  return it;
+}
+
+/*
+ * Destroy the value held by a Slot and mark it Free,
+ * returning its SlotId
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+SlotId VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::vacate( size_t block, Slot<T>* slot )
+{
+  const BlockInfo<T>& info = table_.byId( block );
+  size_t index = slot - info.slots;
+
+  Utils::clearOccupied( info.occupancy, info.summary, index - 1 );
+  if( info.live->fetch_sub( 1, std::memory_order_relaxed ) == 1 ) empty_blocks_.fetch_add( 1, std::memory_order_relaxed );
+  slot->destroy();
+
+  return Utils::makeSlotId( block, index );
+}
+
+/*
+ * Destroy the value held by a Slot and push
+ * it onto the front of a cache
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::removeTo( FreeCache& cache, size_t block, Slot<T>* slot )
+{
+  SlotId free = vacate( block, slot );
+  slot->setNextSlot( cache.head );
+
+  cache.head = free;
+  ++cache.count;
+  cache.live.store( cache.live.load( std::memory_order_relaxed ) - 1, std::memory_order_relaxed );
+}
+
+/*
+ * Construct a new element in-place using a slot from the calling
+ * thread's cache. Only refills, which move a whole batch of slots
+ * at once, touch the shared pool.
+ * Threads beyond MAX_THREAD_CACHES work on the pool directly
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class... Args>
+typename VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::iterator VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::emplace( Args&&... args )
+{
+  FreeCache* cache = getCache();
+
+  if( cache ) {
+    if( cache->head == NULL_SLOT ) refill( *cache );
+
+    iterator it = emplaceFrom( *cache, std::forward<Args>( args )... );
+    stats_.set( Utils::Stat::CachedFree, cache->count );
+    return it;
+  }
+
+  size_t node = currentNode();
+
+  auto functor = [&]() -> iterator {
+    FreePool& pool = pools_[node];
+    if( !pool.count ) grow( node );
+
+    Slot<T>* tail;
+    SlotId slot = takeSlots( node, 1, tail );
+    iterator it;
+
+    try {
+      it = emplaceAt( slot, std::forward<Args>( args )... );
+    } catch( ... ) {
+      giveSlot( slot );
+      throw;
+    }
+
+    pool.live.store( pool.live.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+    return it;
+  };
+
+  return Utils::spinLockExecutor<LockPolicy>( functor, lock_ );
+}
+
+/*
+ * Destroy the value held by a Slot and give it to the
+ * calling thread's cache, flushing a batch back to the
+ * pool once the cache grows past THREAD_CACHE_SIZE.
+ * A slot of a block for another node than the cache's goes
+ * straight back to the pool of its own node, so a cache only
+ * ever holds slots of one node. An empty cache first moves to
+ * the node the calling thread is on now
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::removeAt( size_t block, Slot<T>* slot )
+{
+  FreeCache* cache = getCache();
+  size_t node = table_.byId( block ).node;
+
+  if( cache && cache->head == NULL_SLOT ) cache->node = currentNode();
+
+  if( cache && cache->node == node ) {
+    removeTo( *cache, block, slot );
+    if( cache->count > THREAD_CACHE_SIZE ) flush( *cache );
+    stats_.set( Utils::Stat::CachedFree, cache->count );
+    return;
+  }
+
+  auto functor = [&]() -> void {
+    FreePool& pool = pools_[node];
+
+    giveSlot( vacate( block, slot ) );
+    pool.live.store( pool.live.load( std::memory_order_relaxed ) - 1, std::memory_order_relaxed );
+  };
+
+  Utils::spinLockExecutor<LockPolicy>( functor, lock_ );
+}
+
+/*
+ * Remove the element an iterator points to.
+ * Waits for any withLocked()/tryUpdate() call on the same
+ * element to finish first. Returns false if the element was
+ * removed by then, so of threads racing to remove the same
+ * element exactly one does. The iterator keeps pointing at the
+ * now Free slot so incrementing it afterwards is still valid
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+bool VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::remove( iterator& it )
+{
+  auto functor = [&]() -> bool {
+    if( !Utils::testBit( it.info_->occupancy, it.slot_ - it.info_->slots - 1 ) ) return false;
+
+    removeAt( it.info_->id, it.slot_ );
+    return true;
+  };
+
+  return Utils::spinLockExecutor<LockPolicy>( functor, getLock( it ) );
+}
+
+/*
+ * Detach a chain of n Free slots, ending in NULL_SLOT, using up
+ * the calling thread's cache before the pool of its node. Capacity
+ * the pool lacks is added as blocks as large as the growth policy allows,
+ * whose slots lead the chain in order, so a bulk insert mostly
+ * sees long runs of consecutive slots
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+SlotId VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::takeFree( size_t n )
+{
+  FreeCache* cache = getCache();
+  SlotId cached = NULL_SLOT;
+  Slot<T>* cached_tail = nullptr;
+  size_t num_cached = cache ? std::min( n, cache->count ) : 0;
+
+  if( num_cached ) {
+    cached = cache->head;
+    cached_tail = getSlot( cached );
+
+    for( size_t i = 1; i < num_cached; ++i ) {
+      cached_tail = getSlot( cached_tail->getNextSlot() );
+    }
+
+    cache->head = cached_tail->getNextSlot();
+    cache->count -= num_cached;
+    cached_tail->setNextSlot( NULL_SLOT );
+    stats_.set( Utils::Stat::CachedFree, cache->count );
+  }
+
+  if( num_cached == n ) return cached;
+
+  size_t node = currentNode();
+  FreePool& pool = pools_[node];
+
+  auto functor = [&]() -> SlotId {
+    size_t wanted = n - num_cached;
+
+    while( pool.count < wanted ) {
+      pushBlock( Utils::clampBlockSize( wanted - pool.count, GrowthPolicy::minSize(), GrowthPolicy::maxSize() ), node );
+    }
+
+    Slot<T>* tail;
+    SlotId head = takeSlots( node, wanted, tail );
+    tail->setNextSlot( cached );
+
+    return head;
+  };
+
+  return Utils::spinLockExecutor<LockPolicy>( functor, lock_ );
+}
+
+/*
+ * Give a chain of Free slots ending in NULL_SLOT back to
+ * their blocks under a single lock
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::giveFree( SlotId head )
+{
+  Utils::spinLockExecutor<LockPolicy>( [&]() -> void { giveSlots( head ); }, lock_ );
+}
+
+/*
+ * Count delta more Alive Elements against the calling thread
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::addLive( std::ptrdiff_t delta )
+{
+  FreeCache* cache = getCache();
+
+  if( cache ) {
+    cache->live.store( cache->live.load( std::memory_order_relaxed ) + delta, std::memory_order_relaxed );
+    return;
+  }
+
+  Utils::spinLockExecutor<LockPolicy>(
+    [&]() -> void { pools_[0].live.store( pools_[0].live.load( std::memory_order_relaxed ) + delta, std::memory_order_relaxed ); }, lock_ );
+}
+
+/*
+ * Insert n elements taking all of their slots from the pool at once.
+ * fill( slots, len ) constructs len values into consecutive Free
+ * slots of one block, and destroys what it built if it throws.
+ * Each run is then marked Alive a bitmap word at a time.
+ * If fill throws, the elements of earlier runs stay inserted and
+ * the remaining slots go back to the pool
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class F>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::insertSlots( size_t n, F&& fill )
+{
+  if( n == 0 ) return;
+
+  SlotId slot = takeFree( n );
+  size_t inserted = 0;
+
+  while( slot != NULL_SLOT ) {
+    size_t block = Utils::slotBlock( slot );
+    size_t index = Utils::slotIndex( slot );
+    const BlockInfo<T>& info = table_.byId( block );
+    Slot<T>* run = info.slots + index;
+
+    // the links are overwritten by fill, so find the run first
+    size_t len = 1;
+    SlotId next = run->getNextSlot();
+
+    while( next == slot + len ) {
+      next = run[len++].getNextSlot();
+    }
+
+    try {
+      fill( run, len );
+    } catch( ... ) {
+      Utils::setInternalSlotList( run, len, block, index, next );
+      giveFree( slot );
+      addLive( inserted );
+      throw;
+    }
+
+    for( size_t i = 0; i < len; ++i ) {
+      Utils::nextGeneration( info.generations[index + i] );
+    }
+    Utils::setOccupiedRange( info.occupancy, info.summary, index - 1, len );
+    if( info.live->fetch_add( len, std::memory_order_relaxed ) == 0 ) empty_blocks_.fetch_sub( 1, std::memory_order_relaxed );
+
+    inserted += len;
+    slot = next;
+  }
+
+  addLive( inserted );
+}
+
+/*
+ * Insert copies of the elements of [first, last). With forward
+ * iterators all slots are taken at once, and trivially copyable
+ * elements that fill their Slots exactly are copied run by run
+ * with memcpy when the source is contiguous
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class InputIt>
+  requires std::input_iterator<InputIt>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::insert( InputIt first, InputIt last )
+{
+  if constexpr( !std::forward_iterator<InputIt> ) {
+    for( ; first != last; ++first ) {
+      emplace( *first );
+    }
+  } else {
+    typedef std::iter_value_t<InputIt> Value;
+    constexpr bool raw_copy = std::contiguous_iterator<InputIt> && std::is_same_v<Value, T> && std::is_trivially_copyable_v<T> &&
+                              sizeof( Slot<T> ) == sizeof( T );
+
+    auto fill = [&]( Slot<T>* slots, size_t len ) -> void {
+      if constexpr( raw_copy ) {
+        std::memcpy( static_cast<void*>( slots ), std::to_address( first ), len * sizeof( T ) );
+        first += len;
+      } else {
+        Utils::constructSlots( slots, len, [&]( Slot<T>& slot ) -> void {
+          slot.emplace( *first );
+          ++first;
+        } );
+      }
+    };
+
+    insertSlots( static_cast<size_t>( std::distance( first, last ) ), fill );
+  }
+}
+
+/*
+ * Insert n copies of value
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::insert( size_t n, const T& value )
+{
+  auto fill = [&]( Slot<T>* slots, size_t len ) -> void {
+    Utils::constructSlots( slots, len, [&]( Slot<T>& slot ) -> void { slot.emplace( value ); } );
+  };
+
+  insertSlots( n, fill );
+}
+
+/*
+ * Remove the Alive Elements of bits [lo, hi) of a block for which
+ * pred holds, adding their slots to chain.
+ *
+ * The block is processed a bitmap word at a time. The lock of every
+ * candidate is taken before pred sees it and, for the ones that go,
+ * held until the value is destroyed, so this is safe against
+ * withLocked() and tryUpdate() on other threads. Their bits are
+ * cleared with one atomic per word. pred must not lock or remove
+ * elements itself. If pred throws, the locks taken for the current
+ * word are released and chain keeps what earlier words erased
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class Pred>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::eraseBits( size_t block, size_t lo, size_t hi, Pred& pred, FreeChain& chain )
+{
+  const BlockInfo<T>& info = table_.byId( block );
+
+  for( size_t word = lo / BITMAP_WORD_BITS; word * BITMAP_WORD_BITS < hi; ++word ) {
+    uint64_t bits = info.occupancy[word].load( std::memory_order_acquire );
+
+    if( word == lo / BITMAP_WORD_BITS ) bits &= ~uint64_t( 0 ) << ( lo % BITMAP_WORD_BITS );
+    if( hi - word * BITMAP_WORD_BITS < BITMAP_WORD_BITS ) bits &= ( uint64_t( 1 ) << ( hi % BITMAP_WORD_BITS ) ) - 1;
+
+    uint64_t mask = 0;
+
+    for( ; bits; bits &= bits - 1 ) {
+      size_t bit = std::countr_zero( bits );
+      size_t index = word * BITMAP_WORD_BITS + bit + 1;
+      std::atomic_flag& lock = info.locks[index];
+
+      LockPolicy::lock( lock );
+
+      bool match;
+
+      try {
+        match = Utils::testBit( info.occupancy, index - 1 ) && pred( info.slots[index].get() );
+      } catch( ... ) {
+        LockPolicy::unlock( lock );
+        for( ; mask; mask &= mask - 1 ) {
+          LockPolicy::unlock( info.locks[word * BITMAP_WORD_BITS + std::countr_zero( mask ) + 1] );
+        }
+        throw;
+      }
+
+      if( match ) {
+        mask |= uint64_t( 1 ) << bit;
+      } else {
+        LockPolicy::unlock( lock );
+      }
+    }
+
+    if( !mask ) continue;
+
+    size_t count = std::popcount( mask );
+    Utils::clearOccupiedMask( info.occupancy, info.summary, word, mask );
+    if( info.live->fetch_sub( count, std::memory_order_relaxed ) == count ) empty_blocks_.fetch_add( 1, std::memory_order_relaxed );
+
+    for( ; mask; mask &= mask - 1 ) {
+      size_t index = word * BITMAP_WORD_BITS + std::countr_zero( mask ) + 1;
+      Slot<T>* slot = info.slots + index;
+
+      slot->destroy();
+      slot->setNextSlot( chain.head );
+      chain.head = Utils::makeSlotId( block, index );
+
+      LockPolicy::unlock( info.locks[index] );
+    }
+
+    chain.count += count;
+  }
+}
+
+/*
+ * Remove the Alive Elements in [first, last) for which pred
+ * holds. The freed slots go back to their blocks under a
+ * single lock once every block was visited, or as soon as
+ * pred throws
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class Pred>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::eraseRange( const iterator& first, const iterator& last, Pred&& pred )
+{
+  FreeChain chain;
+
+  for( size_t block = first.info_->position; block <= last.info_->position; ++block ) {
+    const BlockInfo<T>& info = table_[block];
+
+    // bits [lo, hi) of this block are in the range
+    size_t lo = 0;
+    size_t hi = info.size;
+
+    if( &info == first.info_ ) {
+      size_t index = first.slot_ - info.slots;
+      lo = index == 0 ? 0 : index - 1;
+    }
+
+    if( &info == last.info_ ) {
+      size_t index = last.slot_ - info.slots;
+      hi = index == 0 ? 0 : index - 1;
+    }
+
+    try {
+      eraseBits( info.id, lo, hi, pred, chain );
+    } catch( ... ) {
+      giveErased( &chain, 1 );
+      throw;
+    }
+  }
+
+  return giveErased( &chain, 1 );
+}
+
+/*
+ * Give the slots of n chains filled by eraseBits() back to their
+ * blocks and count them out of the live elements
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::giveErased( FreeChain* chains, size_t n )
+{
+  size_t erased = 0;
+
+  for( size_t i = 0; i < n; ++i ) {
+    if( !chains[i].count ) continue;
+
+    giveFree( chains[i].head );
+    erased += chains[i].count;
+  }
+
+  if( erased ) addLive( -static_cast<std::ptrdiff_t>( erased ) );
+  return erased;
+}
+
+/*
+ * Remove every Element for which pred holds. pred is called
+ * with the element's lock held, so it must not lock or remove
+ * elements itself. Elements are visited in iteration order, 64
+ * bitmap bits at a time. If pred throws, the exception propagates
+ * after the following:
+ *  - the matches in the bitmap words before the one it threw in
+ *    are removed and no longer counted by size()
+ *  - the elements of that word, matched or not, are unlocked and
+ *    kept, and so are all elements after it
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class Pred>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::eraseIf( Pred pred )
+{
+  return eraseRange( rbegin(), end(), pred );
+}
+
+/*
+ * Remove every Element in [first, last)
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::erase( const iterator& first, const iterator& last )
+{
+  return eraseRange( first, last, []( const T& ) -> bool { return true; } );
+}
+
+/*
+ * Construct a new element like emplace() and return a Handle to it.
+ * If it lands in a block whose id a Handle cannot hold, it is
+ * removed again and std::length_error is thrown, so nothing is
+ * inserted on throw
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class... Args>
+Handle VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::emplaceHandle( Args&&... args )
+{
+  iterator it = emplace( std::forward<Args>( args )... );
+
+  try {
+    return handleOf( it );
+  } catch( const std::length_error& ) {
+    remove( it );
+    throw;
+  }
+}
+
+/*
+ * A Handle to the Alive Element an iterator points to.
+ * It stays valid until that element is removed. Throws
+ * std::length_error if the id of the block is too large for a
+ * Handle, which takes more than 2^HANDLE_BLOCK_BITS blocks at once
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+Handle VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::handleOf( const iterator& it ) const
+{
+  assert( it.getState() == ElementState::Alive );
+  if( it.info_->id >= ( size_t( 1 ) << HANDLE_BLOCK_BITS ) ) throw std::length_error( "too many blocks for a Handle" );
+
+  size_t index = it.slot_ - it.info_->slots;
+  return Utils::makeHandle( it.info_->id, index, it.info_->generations[index].load( std::memory_order_relaxed ) );
+}
+
+/*
+ * The block a Handle refers to, or null if the Handle is
+ * NULL_HANDLE or its block has been trimmed away. The block may
+ * be a newer one under the same id, whose generations tell
+ * the Handle is stale
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+const BlockInfo<T>* VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::handleInfo( Handle handle ) const
+{
+  if( handle == NULL_HANDLE ) return nullptr;
+
+  const BlockInfo<T>* info = table_.published( Utils::handleBlock( handle ) );
+  if( !info || Utils::handleIndex( handle ) > info->size ) return nullptr;
+
+  return info;
+}
+
+/*
+ * Whether the slot of a Handle still holds the element the Handle
+ * was made for. The occupancy bit is read first so a generation
+ * started by a concurrent insert is always seen with its bit
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+bool VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::isCurrent( const BlockInfo<T>& info, Handle handle ) const
+{
+  size_t index = Utils::handleIndex( handle );
+
+  return Utils::testBit( info.occupancy, index - 1 )
+         && Utils::sameGeneration( info.generations[index].load( std::memory_order_relaxed ), Utils::handleGeneration( handle ) );
+}
+
+/*
+ * The element a Handle was made for, or null once it has been
+ * removed, even if its slot has been filled again since. Like an
+ * iterator, the pointer must not be used past a concurrent remove
+ * of the element; update() and remove() check under the lock
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+T* VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::get( Handle handle )
+{
+  const BlockInfo<T>* info = handleInfo( handle );
+  if( !info || !isCurrent( *info, handle ) ) return nullptr;
+
+  return &info->slots[Utils::handleIndex( handle )].get();
+}
+
+/*
+ * Call f with the element a Handle was made for while holding its
+ * lock. Returns false without calling f if it has been removed
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class F>
+bool VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::update( Handle handle, F&& f )
+{
+  const BlockInfo<T>* info = handleInfo( handle );
+  if( !info ) return false;
+
+  size_t index = Utils::handleIndex( handle );
+
+  auto functor = [&]() -> bool {
+    if( !isCurrent( *info, handle ) ) return false;
+
+    f( info->slots[index].get() );
+    return true;
+  };
+
+  return Utils::spinLockExecutor<LockPolicy>( functor, info->locks[index] );
+}
+
+/*
+ * Remove the element a Handle was made for. Returns false if
+ * it has already been removed, so a stale Handle never removes
+ * whatever took its slot
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+bool VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::remove( Handle handle )
+{
+  const BlockInfo<T>* info = handleInfo( handle );
+  if( !info ) return false;
+
+  size_t index = Utils::handleIndex( handle );
+
+  auto functor = [&]() -> bool {
+    if( !isCurrent( *info, handle ) ) return false;
+
+    removeAt( Utils::handleBlock( handle ), info->slots + index );
+    return true;
+  };
+
+  return Utils::spinLockExecutor<LockPolicy>( functor, info->locks[index] );
+}
+
+/*
+ * Obtain the per-element lock of the Slot an iterator points to
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+std::atomic_flag& VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::getLock( const iterator& it )
+{
+  return it.info_->locks[it.slot_ - it.info_->slots];
+}
+
+/*
+ * Call f with a reference to the element an iterator points to
+ * while holding that element's lock. Threads working on different
+ * elements never contend. The lock is not recursive, so f must not
+ * remove or lock the same element again.
+ * If the element was removed while waiting for the lock, f is not
+ * called and false, or an empty optional if f returns a value, is returned
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class F>
+auto VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::withLocked( iterator& it, F&& f ) -> Utils::MaybeResult<decltype( f( std::declval<T&>() ) )>
+{
+  Utils::SpinLockGuard<LockPolicy> guard( getLock( it ) );
+
+  if( it.getState() != ElementState::Alive ) return {};
+
+  if constexpr( std::is_void_v<decltype( f( *it ) )> ) {
+    f( *it );
+    return true;
+  } else {
+    return f( *it );
+  }
+}
+
+/*
+ * Like withLocked() but never waits. Returns false without calling
+ * f if the element is locked by another caller or is no longer Alive
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class F>
+bool VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::tryUpdate( iterator& it, F&& f )
+{
+  std::atomic_flag& lock = getLock( it );
+
+  if( !LockPolicy::tryLock( lock ) ) return false;
+  Utils::SpinLockGuard<LockPolicy> guard( lock, std::adopt_lock );
+
+  if( it.getState() != ElementState::Alive ) return false;
+
+  f( *it );
+  return true;
+}
+
+/*
+ * The first Alive Element
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+typename VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::iterator VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::begin( void )
+{
+  return ++rbegin();
+}
+
+/*
+ * The tail Boundary of the last published block
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+typename VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::iterator VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::end( void )
+{
+  const BlockInfo<T>& info = table_[table_.size() - 1];
+
+  return iterator( table_, info, info.slots + info.size + 1, &stats_ );
+}
+
+/*
+ * The head Boundary of the first block
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+typename VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::iterator VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::rbegin( void )
+{
+  return iterator( table_, table_[0], table_[0].slots, &stats_ );
+}
+
+/*
+ * The last Alive Element
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+typename VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::iterator VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::rend( void )
+{
+  return --end();
+}
+
+/*
+ * The published blocks as segments, see vectorlist/segments.hpp.
+ * Given a node, only the blocks for that node
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+VectorListSegments<T> VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::segments( size_t node ) const
+{
+  return VectorListSegments<T>( table_, node );
+}
+
+/*
+ * Position of the block holding slot k of [0, capacity()), found
+ * by a binary search on the offsets of the published blocks.
+ * Returns table_.size() if k is past the last slot
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::blockAt( size_t k ) const
+{
+  size_t num_blocks = table_.size();
+  size_t lo = 0;
+  size_t hi = num_blocks;
+
+  // last block in [0, num_blocks) with offset <= k
+  while( hi - lo > 1 ) {
+    size_t mid = lo + ( hi - lo ) / 2;
+    if( table_[mid].offset <= k ) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+
+  const BlockInfo<T>& info = table_[lo];
+  return k >= info.offset && k - info.offset < info.size ? lo : num_blocks;
+}
+
+/*
+ * The element in slot k of [0, capacity()), or null if that slot
+ * is Free or out of range. Slots are numbered block by block in
+ * iteration order, so the same k names the same slot until the
+ * container is trimmed
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+T* VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::slotAt( size_t k )
+{
+  size_t block = blockAt( k );
+  if( block == table_.size() ) return nullptr;
+
+  const BlockInfo<T>& info = table_[block];
+  size_t bit = k - info.offset;
+
+  return Utils::testBit( info.occupancy, bit ) ? &info.slots[bit + 1].get() : nullptr;
+}
+
+/*
+ * The first Alive Element in slot k or after, or end(). Together
+ * with indexOf() this lets workers split [0, capacity()) into even
+ * ranges without walking the container first
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+typename VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::iterator VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::iteratorAt( size_t k )
+{
+  size_t block = blockAt( k );
+  if( block == table_.size() ) return end();
+
+  // start on the slot before k, which may be the head Boundary
+  const BlockInfo<T>& info = table_[block];
+  iterator it( table_, info, info.slots + ( k - info.offset ), &stats_ );
+  return ++it;
+}
+
+/*
+ * The slot number of the element an iterator points to, the
+ * inverse of slotAt(). An end iterator gives the number of slots
+ * up to its block, capacity() for end() itself
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::indexOf( const iterator& it ) const
+{
+  size_t index = it.slot_ - it.info_->slots;
+
+  assert( index > 0 );
+  return it.info_->offset + index - 1;
+}
+
+/*
+ * A snapshot of the counters of a counting StatsPolicy, summed over
+ * the threads only now. The free slot counts are read under the
+ * container lock, the counters are not, so a snapshot taken while
+ * other threads run is only as exact as their latest relaxed stores
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+Utils::ContainerStats VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::stats( void )
+  requires StatsPolicy::enabled
+{
+  Utils::ContainerStats snapshot;
+
+  snapshot.blocks_pushed = stats_.total( Utils::Stat::BlocksPushed );
+  snapshot.refills = stats_.total( Utils::Stat::Refills );
+  snapshot.flushes = stats_.total( Utils::Stat::Flushes );
+  snapshot.iteration_steps = stats_.total( Utils::Stat::IterationSteps );
+  snapshot.slots_skipped = stats_.total( Utils::Stat::SlotsSkipped );
+  snapshot.relocations = stats_.total( Utils::Stat::Relocations );
+
+  snapshot.cached_free.resize( MAX_THREAD_CACHES );
+  for( size_t thread = 0; thread < MAX_THREAD_CACHES; ++thread ) {
+    snapshot.cached_free[thread] = stats_.get( thread, Utils::Stat::CachedFree );
+  }
+
+  auto functor = [&]() -> size_t {
+    size_t free = 0;
+
+    for( size_t node = 0; node < num_nodes_; ++node ) {
+      free += pools_[node].count;
+    }
+
+    return free;
+  };
+  snapshot.pool_free = Utils::spinLockExecutor<LockPolicy>( functor, lock_ );
+
+  Utils::LockStats& lock_stats = LockPolicy::stats();
+  snapshot.lock_contended = lock_stats.contended.load( std::memory_order_relaxed );
+  snapshot.lock_spins = lock_stats.spins.load( std::memory_order_relaxed );
+  snapshot.lock_yields = lock_stats.yields.load( std::memory_order_relaxed );
+  snapshot.lock_waits = lock_stats.waits.load( std::memory_order_relaxed );
+
+  return snapshot;
+}
+
+/*
+ * Split the published blocks into chunks of at most
+ * PARALLEL_CHUNK_WORDS bitmap words for the parallel algorithms,
+ * keeping only the blocks for node unless it is ALL_NODES.
+ * Blocks added after the call are not part of any chunk
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+std::vector<Utils::BlockChunk> VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::makeChunks( size_t node ) const
+{
+  std::vector<Utils::BlockChunk> chunks;
+  size_t num_blocks = table_.size();
+
+  for( size_t block = 0; block < num_blocks; ++block ) {
+    const BlockInfo<T>& info = table_[block];
+    size_t num_words = Utils::bitmapWords( info.size );
+
+    if( node != ALL_NODES && info.node != node ) continue;
+
+    for( size_t word = 0; word < num_words; word += PARALLEL_CHUNK_WORDS ) {
+      chunks.push_back( Utils::BlockChunk{ block, word, std::min<size_t>( word + PARALLEL_CHUNK_WORDS, num_words ) } );
+    }
+  }
+
+  return chunks;
+}
+
+/*
+ * Hand the chunks out to num_threads threads one at a time
+ * through a shared counter, so a thread that drew sparse chunks
+ * simply takes more of them
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class F>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::runChunks( const std::vector<Utils::BlockChunk>& chunks, size_t num_threads, F&& work )
+{
+  std::atomic<size_t> next{ 0 };
+
+  Utils::parallelRun( num_threads, [&]( size_t t ) -> void {
+    for( size_t i = next.fetch_add( 1, std::memory_order_relaxed ); i < chunks.size();
+         i = next.fetch_add( 1, std::memory_order_relaxed ) ) {
+      work( t, chunks[i] );
+    }
+  } );
+}
+
+/*
+ * Call f on every Alive Element of a chunk
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class F>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::forEachIn( const Utils::BlockChunk& chunk, F& f )
+{
+  const BlockInfo<T>& info = table_[chunk.block];
+
+  for( size_t word = chunk.first_word; word < chunk.last_word; ++word ) {
+    uint64_t bits = info.occupancy[word].load( std::memory_order_acquire );
+
+    for( ; bits; bits &= bits - 1 ) {
+      f( info.slots[word * BITMAP_WORD_BITS + std::countr_zero( bits ) + 1].get() );
+    }
+  }
+}
+
+/*
+ * Call f on every Alive Element using num_threads threads, one per
+ * core by default. Like iteration, f runs without the element locks
+ * and must not insert or remove elements. f is called concurrently
+ * and is shared by all threads. Given a node, only the elements in
+ * blocks for that node are visited
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class F>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::parallelForEach( F f, size_t num_threads, size_t node )
+{
+  std::vector<Utils::BlockChunk> chunks = makeChunks( node );
+
+  runChunks( chunks, Utils::parallelThreads( num_threads, chunks.size() ),
+             [&]( size_t, const Utils::BlockChunk& chunk ) -> void { forEachIn( chunk, f ); } );
+}
+
+/*
+ * Combine transform( element ) of every Alive Element with reduce,
+ * starting from init. Each thread reduces the chunks it draws on
+ * its own and the partial results are folded into init at the end,
+ * so reduce must be associative and commutative
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class R, class Transform, class Reduce>
+R VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::parallelReduce( R init, Transform transform, Reduce reduce, size_t num_threads, size_t node )
+{
+  std::vector<Utils::BlockChunk> chunks = makeChunks( node );
+  num_threads = Utils::parallelThreads( num_threads, chunks.size() );
+
+  std::vector<std::optional<R> > partials( num_threads );
+
+  runChunks( chunks, num_threads, [&]( size_t t, const Utils::BlockChunk& chunk ) -> void {
+    std::optional<R>& partial = partials[t];
+
+    auto f = [&]( T& value ) -> void {
+      if( partial ) {
+        partial = reduce( std::move( *partial ), transform( value ) );
+      } else {
+        partial.emplace( transform( value ) );
+      }
+    };
+
+    forEachIn( chunk, f );
+  } );
+
+  for( auto& partial : partials ) {
+    if( partial ) init = reduce( std::move( init ), std::move( *partial ) );
+  }
+
+  return init;
+}
+
+/*
+ * Remove every Element for which pred holds using num_threads
+ * threads. Each thread gathers the slots it frees into a chain of
+ * its own, and each chain goes back to its blocks under a single
+ * lock. The same rules as for eraseIf() apply to pred. A thread
+ * whose pred throws stops there, and the other threads carry on
+ * with the chunks left. Once every thread is done, the first
+ * exception propagates. At that point:
+ *  - every match in a bitmap word pred finished is removed
+ *  - the elements of a word where pred threw are unlocked and kept
+ *  - if every thread threw, so are the elements of chunks that no
+ *    thread reached
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+template <class Pred>
+size_t VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::parallelEraseIf( Pred pred, size_t num_threads, size_t node )
+{
+  std::vector<Utils::BlockChunk> chunks = makeChunks( node );
+  num_threads = Utils::parallelThreads( num_threads, chunks.size() );
+
+  std::vector<FreeChain> freed( num_threads );
+
+  auto work = [&]( size_t t, const Utils::BlockChunk& chunk ) -> void {
+    const BlockInfo<T>& info = table_[chunk.block];
+    size_t lo = chunk.first_word * BITMAP_WORD_BITS;
+    size_t hi = std::min( chunk.last_word * BITMAP_WORD_BITS, info.size );
+
+    eraseBits( info.id, lo, hi, pred, freed[t] );
+  };
+
+  try {
+    runChunks( chunks, num_threads, work );
+  } catch( ... ) {
+    giveErased( freed.data(), freed.size() );
+    throw;
+  }
+
+  return giveErased( freed.data(), freed.size() );
 }
@@ -0,0 +1,407 @@
+#include <stdexcept>
+
+#include "../helpers/mappedfile.hpp"
+
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy> class VectorList;
+
+/*
+ * One entry of the block table as kept in a MappedFile, its arrays
+ * given by their offsets in the file, followed by the free state of
+ * the block. A retired block has no slots but keeps the floor of its id
+ * */
+struct PersistentBlock
+{
+  uint64_t slots;
+  uint64_t locks;
+  uint64_t bitmap;
+  uint64_t generations;
+  uint64_t size;
+  uint64_t node;
+  uint64_t offset;
+  uint64_t floor;
+  uint64_t free_head;
+  uint64_t num_free;
+  uint64_t fresh;
+};
+
+/*
+ * The state of a VectorList kept in a MappedFile, found at the root
+ * of the file. Free lists link slots by SlotId, which does not
+ * depend on where the file is mapped, so the free state of every
+ * block is stored as it is. Boundaries are not stored, they are linked again
+ * when the file is opened. The ids of the blocks that were not
+ * retired are stored in iteration order.
+ *
+ * Only the elements, the bitmaps and the generations are written in
+ * place; the rest is written by sync() as a new state, which becomes
+ * the root once complete
+ * */
+struct PersistentList
+{
+  uint64_t slot_size;
+  uint64_t num_blocks;
+  uint64_t blocks;
+  uint64_t num_ordered;
+  uint64_t order;
+  uint64_t capacity;
+  uint64_t empty_blocks;
+  uint64_t block_size;
+  uint64_t live;
+  uint64_t num_nodes;
+};
+
+/*
+ * Open the VectorList kept in a file, or start a new one in it if
+ * the file holds none yet. Opening takes time in the number of
+ * blocks only: no element is read, the block table is rebuilt
+ * from the offsets in the file and the Boundaries are relinked.
+ *
+ * Every block lives in the file. The state of the container is
+ * written back by sync() and by the destructor, which then leaves
+ * the blocks in the file rather than freeing them. A container
+ * opened from a ReadOnly file can be read by any number of processes
+ * at once and never writes the file. A file is never open for
+ * reading and writing at once, see MappedFile.
+ *
+ * The file is marked dirty while the container is open and clean
+ * once the destructor synced it. If the process dies in between,
+ * the file opens again with:
+ *  - the blocks of the last sync(), each holding the elements it
+ *    held when the process died
+ *  - the blocks trimmed since, empty, as they are only freed by the
+ *    next sync()
+ * and without the blocks added since, whose elements and space in
+ * the file are lost. Handles into them may find other elements
+ * later. So may a Handle to an element being written when the
+ * process died, which may be left half written. Dying while the
+ * container grows, is restored or is synced, when the file itself
+ * allocates or frees, is not covered. Neither is a crash of the
+ * system, which only keeps what sync() flushed
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::VectorList( Utils::MappedFile& file )
+  requires std::is_trivially_copyable_v<T> && std::is_constructible_v<Allocator, std::pmr::memory_resource*>
+    : allocator_( &file )
+    , blocks_( allocator_ )
+    , spares_( allocator_ )
+    , retired_( allocator_ )
+    , caches_( new FreeCache[MAX_THREAD_CACHES] )
+    , pools_( new FreePool[MAX_NUMA_NODES] )
+    , num_nodes_( std::clamp<size_t>( NodePolicy::nodes(), 1, MAX_NUMA_NODES ) )
+    , lock_( ATOMIC_FLAG_INIT )
+    , file_( &file )
+{
+  capacity_ = 0;
+  empty_blocks_ = 0;
+  block_size_ = GrowthPolicy::initial( sizeof( Slot<T> ) );
+
+  for( size_t node = 0; node < num_nodes_; ++node ) {
+    pools_[node].node = node;
+  }
+
+  if( file.root() ) {
+    openFrom( *static_cast<const PersistentList*>( file.at( file.root(), sizeof( PersistentList ) ) ) );
+  } else {
+    blocks_.reserve( INITIAL_BLOCK_SIZE );
+    Utils::spinLockExecutor<LockPolicy>( [this]() -> void { grow( currentNode() ); }, lock_ );
+  }
+
+  if( file.readOnly() ) return;
+
+  try {
+    file.setClean( false );
+  } catch( ... ) {
+    releaseBlocks();
+    throw;
+  }
+}
+
+/*
+ * Rebuild the blocks, the block table and the pools from the
+ * state stored in the file, recovering a file left dirty.
+ * The state is checked first, in time in the number of blocks:
+ * every array must lie in the file, every block must fit a Handle
+ * and MAX_BLOCK_SIZE and mark nothing Alive past its end, its free
+ * chain must start below its fresh slots, the sizes must add up to
+ * the capacity and the order must name every block that was not
+ * retired once. A file that fails any of it throws std::runtime_error.
+ * Past its head, the free chain of a clean file is not walked
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::openFrom( const PersistentList& list )
+{
+  if( list.slot_size != sizeof( Slot<T> ) ) throw std::runtime_error( "the file holds a VectorList of another element type" );
+  if( !list.num_ordered || list.num_ordered > list.num_blocks || list.num_blocks >= ( size_t( 1 ) << HANDLE_BLOCK_BITS ) ||
+      list.num_nodes > MAX_NUMA_NODES ) {
+    throw std::runtime_error( "not a VectorList file" );
+  }
+
+  const PersistentBlock* records = static_cast<const PersistentBlock*>( file_->at( list.blocks, list.num_blocks * sizeof( PersistentBlock ) ) );
+  const uint64_t* order = static_cast<const uint64_t*>( file_->at( list.order, list.num_ordered * sizeof( uint64_t ) ) );
+  size_t capacity = 0;
+
+  // an array of count items at offset, aligned as the file aligns them
+  auto inFile = [&]( uint64_t offset, size_t count, size_t item ) -> bool {
+    if( offset % CACHE_LINE_SIZE ) return false;
+    file_->at( offset, count * item );
+    return true;
+  };
+
+  for( size_t b = 0; b < list.num_blocks; ++b ) {
+    const PersistentBlock& record = records[b];
+    size_t size = record.size;
+
+    if( !record.slots ) continue;
+
+    bool bad_head = record.free_head != NULL_SLOT &&
+                    ( Utils::slotBlock( record.free_head ) != b || Utils::slotIndex( record.free_head ) < 1 ||
+                      Utils::slotIndex( record.free_head ) >= record.fresh );
+    size_t words = Utils::bitmapWords( size ) + Utils::summaryWords( size ) + 1;
+
+    if( !size || size > MAX_BLOCK_SIZE || record.fresh < 1 || record.fresh > size + 1 || record.num_free > size || bad_head ||
+        !inFile( record.slots, size + 2, sizeof( Slot<T> ) ) || !inFile( record.locks, size + 2, sizeof( std::atomic_flag ) ) ||
+        !inFile( record.bitmap, words, sizeof( std::atomic<uint64_t> ) ) ||
+        !inFile( record.generations, size + 2, sizeof( std::atomic<uint32_t> ) ) ) {
+      throw std::runtime_error( "not a VectorList file" );
+    }
+
+    // nothing past the end of the block may be marked Alive
+    const auto* bitmap = static_cast<const std::atomic<uint64_t>*>( file_->at( record.bitmap, words * sizeof( std::atomic<uint64_t> ) ) );
+    size_t tail = size % BITMAP_WORD_BITS;
+    if( tail && bitmap[size / BITMAP_WORD_BITS].load( std::memory_order_relaxed ) >> tail ) throw std::runtime_error( "not a VectorList file" );
+
+    capacity += size;
+  }
+
+  std::vector<bool> seen( list.num_blocks );
+  for( size_t i = 0; i < list.num_ordered; ++i ) {
+    uint64_t id = order[i];
+    if( id >= list.num_blocks || !records[id].slots || seen[id] ) throw std::runtime_error( "not a VectorList file" );
+    seen[id] = true;
+  }
+  if( capacity != list.capacity ) throw std::runtime_error( "not a VectorList file" );
+
+  blocks_.reserve( std::max<size_t>( INITIAL_BLOCK_SIZE, list.num_blocks ) );
+  block_free_.resize( list.num_blocks );
+
+  // the blocks belong to the file, which must not get them back
+  // from a container that failed to open
+  try {
+    for( size_t b = 0; b < list.num_blocks; ++b ) {
+      const PersistentBlock& record = records[b];
+
+      if( !record.slots ) {
+        BlockInfo<T> info{};
+        info.offset = record.offset;
+
+        blocks_.emplace_back( Utils::emptySlotBlock<T>( allocator_ ) );
+        table_.push( info );
+        continue;
+      }
+
+      size_t size = record.size;
+      size_t words = Utils::bitmapWords( size ) + Utils::summaryWords( size ) + 1;
+      SlotBlock<T, Allocator> block(
+        SlotPtr<T, Allocator>( static_cast<Slot<T>*>( file_->at( record.slots, ( size + 2 ) * sizeof( Slot<T> ) ) ), { allocator_, size + 2 } ),
+        LockArray<Allocator>( static_cast<std::atomic_flag*>( file_->at( record.locks, ( size + 2 ) * sizeof( std::atomic_flag ) ) ),
+                              { allocator_, size + 2 } ),
+        BitmapArray<Allocator>( static_cast<std::atomic<uint64_t>*>( file_->at( record.bitmap, words * sizeof( std::atomic<uint64_t> ) ) ),
+                                { allocator_, words } ),
+        GenerationArray<Allocator>(
+          static_cast<std::atomic<uint32_t>*>( file_->at( record.generations, ( size + 2 ) * sizeof( std::atomic<uint32_t> ) ) ),
+          { allocator_, size + 2 } ),
+        size );
+
+      BlockInfo<T> info = Utils::makeBlockInfo( block );
+      info.offset = record.offset;
+      info.node = record.node % num_nodes_;
+      block_free_[b] = BlockFree{ record.free_head, record.num_free, record.fresh };
+
+      blocks_.emplace_back( std::move( block ) );
+      table_.push( info );
+    }
+
+    for( size_t b = 0; b < list.num_blocks; ++b ) {
+      if( !records[b].slots ) table_.retire( b, static_cast<uint32_t>( records[b].floor ) );
+    }
+    table_.reorder( std::vector<size_t>( order, order + list.num_ordered ) );
+    linkBoundaries();
+
+    capacity_ = list.capacity;
+    empty_blocks_ = list.empty_blocks;
+    block_size_ = std::clamp<size_t>( list.block_size, GrowthPolicy::minSize(), GrowthPolicy::maxSize() );
+    pools_[0].live.store( static_cast<std::ptrdiff_t>( list.live ), std::memory_order_relaxed );
+
+    if( !file_->clean() ) recover();
+  } catch( ... ) {
+    releaseBlocks();
+    throw;
+  }
+
+  relistFree();
+}
+
+/*
+ * Rebuild from the bitmaps what a file left dirty holds as it was
+ * at the last sync(): the live counts, the capacity, the empty blocks
+ * and the free state of every block, whose stored chains may run
+ * through slots taken since. The slots past the last Alive one of a
+ * block are fresh and the Free ones before it are chained again.
+ * Summaries are recomputed and the slot locks held when the process
+ * died are let go. restore() uses it too, so a snapshot never brings
+ * in a chain of its own. Throws std::runtime_error if a bitmap marks
+ * slots past the end of its block. Takes time in the number of slots
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::recover( void )
+{
+  size_t live = 0;
+  size_t empty = 0;
+  size_t capacity = 0;
+
+  for( size_t b = 0; b < table_.size(); ++b ) {
+    const BlockInfo<T>& info = table_[b];
+    BlockFree& free = block_free_[info.id];
+    size_t count = 0;
+    size_t tail = info.size % BITMAP_WORD_BITS;
+
+    if( tail && info.occupancy[info.size / BITMAP_WORD_BITS].load( std::memory_order_relaxed ) >> tail ) {
+      throw std::runtime_error( "a block marks slots past its end" );
+    }
+
+    free = BlockFree{};
+    capacity += info.size;
+
+    for( size_t i = 0; i < info.size + 2; ++i ) {
+      info.locks[i].clear( std::memory_order_relaxed );
+    }
+    for( size_t word = 0; word < Utils::summaryWords( info.size ); ++word ) {
+      info.summary[word].store( 0, std::memory_order_relaxed );
+    }
+
+    // from the last word down, so fresh is known before any hole
+    for( size_t word = Utils::bitmapWords( info.size ); word-- > 0; ) {
+      uint64_t bits = info.occupancy[word].load( std::memory_order_relaxed );
+      uint64_t holes = ~bits;
+
+      if( free.fresh == 1 ) {
+        if( !bits ) continue;
+
+        size_t width = std::bit_width( bits );
+        free.fresh = word * BITMAP_WORD_BITS + width + 1;
+        if( width < BITMAP_WORD_BITS ) holes &= ( uint64_t( 1 ) << width ) - 1;
+      }
+
+      if( bits ) {
+        count += std::popcount( bits );
+        Utils::setBit( info.summary, word );
+      }
+
+      for( ; holes; holes &= holes - 1 ) {
+        size_t slot = word * BITMAP_WORD_BITS + std::countr_zero( holes ) + 1;
+
+        info.slots[slot].setNextSlot( free.head );
+        free.head = Utils::makeSlotId( info.id, slot );
+        ++free.count;
+      }
+    }
+
+    info.live->store( count, std::memory_order_relaxed );
+    live += count;
+    if( !count ) ++empty;
+  }
+
+  capacity_ = capacity;
+  empty_blocks_ = empty;
+  pools_[0].live.store( static_cast<std::ptrdiff_t>( live ), std::memory_order_relaxed );
+}
+
+/*
+ * Write the state of the container to its file and flush the file.
+ * The free slots of every thread cache go back to their blocks first,
+ * and the blocks dropped since the last sync go back to the file
+ * once the new state, which no longer names them, is the root.
+ * Throws std::system_error if the file cannot be flushed.
+ * No other thread may use the container while it is synced
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::sync( void )
+{
+  assert( file_ );
+  if( file_->readOnly() ) return;
+
+  auto functor = [&]() -> void {
+    std::ptrdiff_t live = drainCaches();
+
+    size_t num_blocks = table_.ids();
+    size_t num_ordered = table_.size();
+    auto* list = static_cast<PersistentList*>( file_->allocate( sizeof( PersistentList ) ) );
+    auto* records = static_cast<PersistentBlock*>( file_->allocate( num_blocks * sizeof( PersistentBlock ) ) );
+    auto* order = static_cast<uint64_t*>( file_->allocate( num_ordered * sizeof( uint64_t ) ) );
+
+    for( size_t b = 0; b < num_ordered; ++b ) {
+      order[b] = table_[b].id;
+    }
+
+    for( size_t b = 0; b < num_blocks; ++b ) {
+      const BlockInfo<T>& info = table_.byId( b );
+
+      if( !info.slots ) {
+        records[b] = PersistentBlock{ 0, 0, 0, 0, 0, 0, info.offset, table_.floor( b ), NULL_SLOT, 0, 1 };
+        continue;
+      }
+
+      const BlockFree& free = block_free_[b];
+      records[b] = PersistentBlock{ file_->offsetOf( info.slots ), file_->offsetOf( info.locks ), file_->offsetOf( info.occupancy ),
+                                    file_->offsetOf( info.generations ), info.size, info.node, info.offset, table_.floor( b ),
+                                    free.head, free.count, free.fresh };
+    }
+
+    *list = PersistentList{ sizeof( Slot<T> ), num_blocks, file_->offsetOf( records ), num_ordered, file_->offsetOf( order ),
+                            capacity_.load( std::memory_order_relaxed ),
+                            empty_blocks_.load( std::memory_order_relaxed ), block_size_,
+                            static_cast<uint64_t>( live ), num_nodes_ };
+
+    // the old state is only given back once the new one is the root
+    uint64_t old = file_->root();
+    file_->setRoot( file_->offsetOf( list ) );
+
+    if( old ) {
+      const PersistentList* previous = static_cast<const PersistentList*>( file_->at( old, sizeof( PersistentList ) ) );
+      size_t record_bytes = previous->num_blocks * sizeof( PersistentBlock );
+      size_t order_bytes = previous->num_ordered * sizeof( uint64_t );
+
+      file_->deallocate( file_->at( previous->blocks, record_bytes ), record_bytes );
+      file_->deallocate( file_->at( previous->order, order_bytes ), order_bytes );
+      file_->deallocate( file_->at( old, sizeof( PersistentList ) ), sizeof( PersistentList ) );
+    }
+
+    // swapped out rather than cleared, blocks cannot be assigned
+    // when their allocator cannot
+    SlotBlocks<T, Allocator> retired( allocator_ );
+    retired_.swap( retired );
+
+    file_->sync();
+  };
+
+  Utils::spinLockExecutor<LockPolicy>( functor, lock_ );
+}
+
+/*
+ * Let go of the blocks without freeing them, for a container
+ * whose blocks stay in its file after it is gone. A ReadOnly file
+ * only frees blocks that came from the heap, so those of a read
+ * only container are freed as usual
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::releaseBlocks( void )
+{
+  if( file_->readOnly() ) return;
+
+  for( SlotBlock<T, Allocator>& block : blocks_ ) {
+    std::get<SlotPtr<T, Allocator> >( block ).release();
+    std::get<LockArray<Allocator> >( block ).release();
+    std::get<BitmapArray<Allocator> >( block ).release();
+    std::get<GenerationArray<Allocator> >( block ).release();
+  }
+}
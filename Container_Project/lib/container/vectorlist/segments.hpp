@@ -0,0 +1,358 @@
+#ifndef VECTORLISTSEGMENTS_HPP_
+#define VECTORLISTSEGMENTS_HPP_
+
+#include "../globals.hpp"
+#include "../element/slot.hpp"
+#include "./blocktable.hpp"
+
+/*
+ * One block of a VectorList seen as a segment.
+ *
+ * A segment is the range [begin, end) of the Alive Elements of
+ * its block. Inside a block there are no Boundaries to cross and
+ * no table to consult, so the local iterator only walks the set
+ * bits of the occupancy words and forEach() turns every full word
+ * into a plain loop over 64 consecutive slots that the compiler
+ * is free to unroll and vectorize
+ * */
+template <class T> class VectorListSegment
+{
+  private:
+  const BlockInfo<T>* info_;
+  size_t block_;
+
+  public:
+  /*
+   * Forward iterator over the Alive Elements of one block,
+   * holding the bits of the current word still to be visited
+   * */
+  class iterator
+  {
+    private:
+    const BlockInfo<T>* info_;
+    size_t word_;
+    size_t words_;
+    uint64_t bits_;
+
+    void skipEmpty( void );
+
+    public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef T& reference;
+
+    iterator( void );
+    iterator( const BlockInfo<T>* info, size_t word );
+
+    iterator& operator++( void );
+    iterator operator++( int );
+    T& operator*( void ) const;
+    T* operator->( void ) const;
+    bool operator==( const iterator& other ) const;
+    bool operator!=( const iterator& other ) const;
+  };
+
+  VectorListSegment( void );
+  VectorListSegment( const BlockInfo<T>& info, size_t block );
+
+  iterator begin( void ) const;
+  iterator end( void ) const;
+
+  template <class F>
+  void forEach( F&& f ) const;
+
+  size_t block( void ) const;
+  size_t capacity( void ) const;
+  Slot<T>* data( void ) const;
+  const std::atomic<uint64_t>* occupancy( void ) const;
+};
+
+/*
+ * The blocks of a VectorList as a range of segments.
+ *
+ * Only blocks published when the range was made are part of it.
+ * A range made for one NUMA node skips the blocks of every other node
+ * */
+template <class T> class VectorListSegments
+{
+  private:
+  const BlockTable<T>* table_;
+  size_t last_;
+  size_t node_;
+
+  public:
+  class iterator
+  {
+    private:
+    const BlockTable<T>* table_;
+    size_t block_;
+    size_t last_;
+    size_t node_;
+
+    void skipOtherNodes( void );
+
+    public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef VectorListSegment<T> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef void pointer;
+    typedef VectorListSegment<T> reference;
+
+    iterator( void );
+    iterator( const BlockTable<T>& table, size_t block, size_t last, size_t node );
+
+    iterator& operator++( void );
+    iterator operator++( int );
+    VectorListSegment<T> operator*( void ) const;
+    bool operator==( const iterator& other ) const;
+    bool operator!=( const iterator& other ) const;
+  };
+
+  VectorListSegments( const BlockTable<T>& table, size_t node = ALL_NODES );
+
+  iterator begin( void ) const;
+  iterator end( void ) const;
+};
+
+template <class T>
+VectorListSegment<T>::iterator::iterator( void )
+    : info_( nullptr )
+    , word_( 0 )
+    , words_( 0 )
+    , bits_( 0 )
+{
+}
+
+template <class T>
+VectorListSegment<T>::iterator::iterator( const BlockInfo<T>* info, size_t word )
+    : info_( info )
+    , word_( word )
+    , words_( Utils::bitmapWords( info->size ) )
+    , bits_( word < words_ ? info->occupancy[word].load( std::memory_order_acquire ) : 0 )
+{
+  skipEmpty();
+}
+
+/*
+ * Move on to the next word with a set bit, or to the end
+ * */
+template <class T>
+void VectorListSegment<T>::iterator::skipEmpty( void )
+{
+  while( !bits_ && word_ < words_ ) {
+    if( ++word_ < words_ ) bits_ = info_->occupancy[word_].load( std::memory_order_acquire );
+  }
+}
+
+template <class T>
+typename VectorListSegment<T>::iterator& VectorListSegment<T>::iterator::operator++( void )
+{
+  bits_ &= bits_ - 1;
+  skipEmpty();
+  return *this;
+}
+
+template <class T>
+typename VectorListSegment<T>::iterator VectorListSegment<T>::iterator::operator++( int )
+{
+  iterator copy = *this;
+  ++*this;
+  return copy;
+}
+
+template <class T>
+T& VectorListSegment<T>::iterator::operator*( void ) const
+{
+  return info_->slots[word_ * BITMAP_WORD_BITS + std::countr_zero( bits_ ) + 1].get();
+}
+
+template <class T>
+T* VectorListSegment<T>::iterator::operator->( void ) const
+{
+  return &**this;
+}
+
+template <class T>
+bool VectorListSegment<T>::iterator::operator==( const iterator& other ) const
+{
+  return word_ == other.word_ && bits_ == other.bits_;
+}
+
+template <class T>
+bool VectorListSegment<T>::iterator::operator!=( const iterator& other ) const
+{
+  return !( *this == other );
+}
+
+template <class T>
+VectorListSegment<T>::VectorListSegment( void )
+    : info_( nullptr )
+    , block_( 0 )
+{
+}
+
+template <class T>
+VectorListSegment<T>::VectorListSegment( const BlockInfo<T>& info, size_t block )
+    : info_( &info )
+    , block_( block )
+{
+}
+
+template <class T>
+typename VectorListSegment<T>::iterator VectorListSegment<T>::begin( void ) const
+{
+  return iterator( info_, 0 );
+}
+
+template <class T>
+typename VectorListSegment<T>::iterator VectorListSegment<T>::end( void ) const
+{
+  return iterator( info_, Utils::bitmapWords( info_->size ) );
+}
+
+/*
+ * Call f on every Alive Element of the segment. A word with every
+ * bit set covers 64 consecutive slots that are all Alive, so it is
+ * visited by a counted loop over the slots with no bit tests.
+ * Like iteration, f runs without the element locks
+ * */
+template <class T>
+template <class F>
+void VectorListSegment<T>::forEach( F&& f ) const
+{
+  Slot<T>* slots = info_->slots + 1;
+  size_t num_words = Utils::bitmapWords( info_->size );
+
+  for( size_t word = 0; word < num_words; ++word ) {
+    uint64_t bits = info_->occupancy[word].load( std::memory_order_acquire );
+    Slot<T>* base = slots + word * BITMAP_WORD_BITS;
+
+    if( bits == ~uint64_t( 0 ) ) {
+      for( size_t i = 0; i < BITMAP_WORD_BITS; ++i ) {
+        f( base[i].get() );
+      }
+      continue;
+    }
+
+    for( ; bits; bits &= bits - 1 ) {
+      f( base[std::countr_zero( bits )].get() );
+    }
+  }
+}
+
+/*
+ * Position of the block in iteration order, its index in the
+ * container's block table
+ * */
+template <class T>
+size_t VectorListSegment<T>::block( void ) const
+{
+  return block_;
+}
+
+template <class T>
+size_t VectorListSegment<T>::capacity( void ) const
+{
+  return info_->size;
+}
+
+/*
+ * The slots of the block, Slot i + 1 being the one bit i of the
+ * occupancy bitmap stands for. Boundaries sit at both ends
+ * */
+template <class T>
+Slot<T>* VectorListSegment<T>::data( void ) const
+{
+  return info_->slots;
+}
+
+template <class T>
+const std::atomic<uint64_t>* VectorListSegment<T>::occupancy( void ) const
+{
+  return info_->occupancy;
+}
+
+template <class T>
+VectorListSegments<T>::iterator::iterator( void )
+    : table_( nullptr )
+    , block_( 0 )
+    , last_( 0 )
+    , node_( ALL_NODES )
+{
+}
+
+template <class T>
+VectorListSegments<T>::iterator::iterator( const BlockTable<T>& table, size_t block, size_t last, size_t node )
+    : table_( &table )
+    , block_( block )
+    , last_( last )
+    , node_( node )
+{
+  skipOtherNodes();
+}
+
+template <class T>
+void VectorListSegments<T>::iterator::skipOtherNodes( void )
+{
+  while( block_ < last_ && node_ != ALL_NODES && ( *table_ )[block_].node != node_ ) {
+    ++block_;
+  }
+}
+
+template <class T>
+typename VectorListSegments<T>::iterator& VectorListSegments<T>::iterator::operator++( void )
+{
+  ++block_;
+  skipOtherNodes();
+  return *this;
+}
+
+template <class T>
+typename VectorListSegments<T>::iterator VectorListSegments<T>::iterator::operator++( int )
+{
+  iterator copy = *this;
+  ++*this;
+  return copy;
+}
+
+template <class T>
+VectorListSegment<T> VectorListSegments<T>::iterator::operator*( void ) const
+{
+  return VectorListSegment<T>( ( *table_ )[block_], block_ );
+}
+
+template <class T>
+bool VectorListSegments<T>::iterator::operator==( const iterator& other ) const
+{
+  return block_ == other.block_;
+}
+
+template <class T>
+bool VectorListSegments<T>::iterator::operator!=( const iterator& other ) const
+{
+  return !( *this == other );
+}
+
+template <class T>
+VectorListSegments<T>::VectorListSegments( const BlockTable<T>& table, size_t node )
+    : table_( &table )
+    , last_( table.size() )
+    , node_( node )
+{
+}
+
+template <class T>
+typename VectorListSegments<T>::iterator VectorListSegments<T>::begin( void ) const
+{
+  return iterator( *table_, 0, last_, node_ );
+}
+
+template <class T>
+typename VectorListSegments<T>::iterator VectorListSegments<T>::end( void ) const
+{
+  return iterator( *table_, last_, last_, node_ );
+}
+
+#endif // VECTORLISTSEGMENTS_HPP_
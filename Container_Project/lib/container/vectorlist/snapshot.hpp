@@ -0,0 +1,211 @@
+#include <stdexcept>
+
+#include "../helpers/fileio.hpp"
+
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy> class VectorList;
+
+/*
+ * The start of a snapshot. One SnapshotBlock follows for every
+ * block id handed out, each followed by the arrays of its block
+ * unless the block was retired. The ids of the num_ordered blocks
+ * that were not retired come last, in iteration order
+ * */
+struct SnapshotHeader
+{
+  uint64_t magic;
+  uint64_t slot_size;
+  uint64_t num_blocks;
+  uint64_t num_ordered;
+  uint64_t capacity;
+  uint64_t empty_blocks;
+  uint64_t block_size;
+  uint64_t live;
+  uint64_t num_nodes;
+};
+
+/*
+ * A block as written to a snapshot, with the chain of Free slots
+ * given back to it, their number, and its first fresh slot. The
+ * free state is only informative, restore() does not read it back
+ * */
+struct SnapshotBlock
+{
+  uint64_t size;
+  uint64_t node;
+  uint64_t offset;
+  uint64_t floor;
+  uint64_t free_head;
+  uint64_t num_free;
+  uint64_t fresh;
+};
+
+namespace Utils
+{
+/*
+ * The arrays of a block as they are written to a snapshot: the
+ * Slots with their Boundaries, the bitmap with its summary and live
+ * count, and the generations. The locks are left out, they are all
+ * clear while nothing else uses the container
+ * */
+template <class T>
+int blockParts( const BlockInfo<T>& info, iovec* parts )
+{
+  size_t bitmap_words = bitmapWords( info.size ) + summaryWords( info.size ) + 1;
+
+  parts[0] = iovec{ info.slots, ( info.size + 2 ) * sizeof( Slot<T> ) };
+  parts[1] = iovec{ info.occupancy, bitmap_words * sizeof( std::atomic<uint64_t> ) };
+  parts[2] = iovec{ info.generations, ( info.size + 2 ) * sizeof( std::atomic<uint32_t> ) };
+  return 3;
+}
+}
+
+/*
+ * Write the whole container to fd, a block at a time with one
+ * writev each, without visiting a single element. The free state
+ * of every block is written too, though restore() rebuilds it from
+ * the bitmap instead. The free slots of every thread cache go back
+ * to their blocks first.
+ * No other thread may use the container while it is written
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::snapshot( int fd )
+  requires std::is_trivially_copyable_v<T>
+{
+  auto functor = [&]() -> void {
+    std::ptrdiff_t live = drainCaches();
+    size_t num_blocks = table_.ids();
+    std::vector<uint64_t> order( table_.size() );
+
+    for( size_t b = 0; b < order.size(); ++b ) {
+      order[b] = table_[b].id;
+    }
+
+    SnapshotHeader header{ SNAPSHOT_MAGIC, sizeof( Slot<T> ), num_blocks, order.size(), capacity_.load( std::memory_order_relaxed ),
+                           empty_blocks_.load( std::memory_order_relaxed ), block_size_,
+                           static_cast<uint64_t>( live ), num_nodes_ };
+
+    iovec part{ &header, sizeof( header ) };
+    Utils::writeAll( fd, &part, 1 );
+
+    for( size_t b = 0; b < num_blocks; ++b ) {
+      const BlockInfo<T>& info = table_.byId( b );
+      const BlockFree& free = block_free_[b];
+      SnapshotBlock record{ info.slots ? info.size : 0, info.node, info.offset, table_.floor( b ), free.head, free.count, free.fresh };
+
+      iovec parts[4] = { { &record, sizeof( record ) } };
+      int count = info.slots ? 1 + Utils::blockParts( info, parts + 1 ) : 1;
+
+      Utils::writeAll( fd, parts, count );
+    }
+
+    part = iovec{ order.data(), order.size() * sizeof( uint64_t ) };
+    Utils::writeAll( fd, &part, 1 );
+  };
+
+  Utils::spinLockExecutor<LockPolicy>( functor, lock_ );
+}
+
+/*
+ * Replace the contents of the container with a snapshot read from
+ * fd. Every block is allocated at its final size, bound to its node
+ * and filled by a single readv, which also brings in the record of
+ * the next block, or the order after the last one. The Boundaries
+ * are linked again, and the free state and the counts of every block
+ * are rebuilt from its bitmap as for a file left dirty, see recover(),
+ * so no free list read from fd is ever followed.
+ *
+ * A snapshot of another element type throws std::runtime_error and
+ * leaves the container as it was. A snapshot that cannot be read in
+ * full or whose blocks do not add up throws too, leaving the
+ * container empty.
+ * No other thread may use the container while it is restored
+ * */
+template <class T, class LockPolicy, class GrowthPolicy, class Allocator, class StatsPolicy, class NodePolicy>
+void VectorList<T, LockPolicy, GrowthPolicy, Allocator, StatsPolicy, NodePolicy>::restore( int fd )
+  requires std::is_trivially_copyable_v<T>
+{
+  auto functor = [&]() -> void {
+    SnapshotHeader header;
+    SnapshotBlock record;
+
+    // a snapshot always holds at least one block
+    iovec parts[4] = { { &header, sizeof( header ) }, { &record, sizeof( record ) } };
+    Utils::readAll( fd, parts, 2 );
+
+    if( header.magic != SNAPSHOT_MAGIC || !header.num_ordered || header.num_ordered > header.num_blocks ||
+        header.num_blocks >= ( size_t( 1 ) << HANDLE_BLOCK_BITS ) || header.num_nodes > MAX_NUMA_NODES ) {
+      throw std::runtime_error( "not a VectorList snapshot" );
+    }
+    if( header.slot_size != sizeof( Slot<T> ) ) throw std::runtime_error( "the snapshot holds a VectorList of another element type" );
+
+    resetBlocks();
+
+    try {
+      std::vector<uint64_t> floors( header.num_blocks );
+      std::vector<size_t> order( header.num_ordered );
+      block_free_.resize( header.num_blocks );
+
+      for( size_t b = 0; b < header.num_blocks; ++b ) {
+        size_t size = record.size;
+        BlockInfo<T> info{};
+        info.offset = record.offset;
+        floors[b] = record.floor;
+
+        if( size > MAX_BLOCK_SIZE ) throw std::runtime_error( "not a VectorList snapshot" );
+
+        SlotBlock<T, Allocator> block = size ? Utils::allocateSlotBlock<T>( size, allocator_ ) : Utils::emptySlotBlock<T>( allocator_ );
+        int count = 0;
+
+        if( size ) {
+          size_t offset = info.offset;
+          info = Utils::makeBlockInfo( block );
+          info.offset = offset;
+          info.node = record.node % num_nodes_;
+
+          NodePolicy::bind( info.slots, ( size + 2 ) * sizeof( Slot<T> ), info.node );
+          count = Utils::blockParts( info, parts );
+        }
+
+        if( b + 1 < header.num_blocks ) {
+          parts[count++] = iovec{ &record, sizeof( record ) };
+        } else {
+          parts[count++] = iovec{ order.data(), order.size() * sizeof( uint64_t ) };
+        }
+        Utils::readAll( fd, parts, count );
+
+        blocks_.emplace_back( std::move( block ) );
+        table_.push( info );
+      }
+
+      // the order names every block that was not retired once
+      std::vector<bool> seen( header.num_blocks );
+      for( size_t id : order ) {
+        if( id >= header.num_blocks || !table_.byId( id ).slots || seen[id] ) throw std::runtime_error( "not a VectorList snapshot" );
+        seen[id] = true;
+      }
+
+      for( size_t id = 0; id < header.num_blocks; ++id ) {
+        if( !table_.byId( id ).slots ) table_.retire( id, static_cast<uint32_t>( floors[id] ) );
+      }
+      table_.reorder( order );
+
+      // the stored free state and counts are not trusted but rebuilt from
+      // the bitmaps, which must then agree with the counts of the header
+      recover();
+      if( capacity_.load( std::memory_order_relaxed ) != header.capacity ||
+          pools_[0].live.load( std::memory_order_relaxed ) != static_cast<std::ptrdiff_t>( header.live ) ) {
+        throw std::runtime_error( "not a VectorList snapshot" );
+      }
+    } catch( ... ) {
+      resetBlocks();
+      grow( currentNode() );
+      throw;
+    }
+
+    linkBoundaries();
+    block_size_ = std::clamp<size_t>( header.block_size, GrowthPolicy::minSize(), GrowthPolicy::maxSize() );
+    relistFree();
+  };
+
+  Utils::spinLockExecutor<LockPolicy>( functor, lock_ );
+}
@@ -1,37 +1,264 @@
 #ifndef VECTORLIST_HPP_
 #define VECTORLIST_HPP_
 
+#include <memory_resource>
+#include <optional>
+
 #include "../globals.hpp"
-#include "../element/element.hpp"
+#include "../element/slot.hpp"
+#include "../helpers/growthpolicies.hpp"
+#include "../helpers/mappedfile.hpp"
+#include "../helpers/nodepolicies.hpp"
+#include "../helpers/parallel.hpp"
+#include "../helpers/statspolicies.hpp"
 #include "../tests/test.hpp"
+#include "./blocktable.hpp"
+#include "./iterator.hpp"
+#include "./segments.hpp"
+
+struct PersistentList;
 
-template <class T> class VectorList
+/*
+ * LockPolicy decides how threads wait on the container lock
+ * and on the per-element locks, see helpers/lockpolicies.hpp.
+ * GrowthPolicy decides the size of each new block,
+ * see helpers/growthpolicies.hpp.
+ * Allocator provides the memory of every block, its lock array
+ * and its bitmap.
+ * StatsPolicy decides whether the container counts what it does,
+ * see helpers/statspolicies.hpp.
+ * NodePolicy tells which NUMA node each thread runs on,
+ * see helpers/nodepolicies.hpp.
+ * A VectorList of trivially copyable T can also live in a
+ * memory-mapped file, see vectorlist/persistence.hpp, and be
+ * written to and read from any file, see vectorlist/snapshot.hpp
+ * */
+template <class T, class LockPolicy = Utils::BackoffPolicy, class GrowthPolicy = Utils::LinearGrowth<>,
+          class Allocator = std::allocator<T>, class StatsPolicy = Utils::NoStats, class NodePolicy = Utils::SingleNode>
+class VectorList
 {
+public:
+  typedef T value_type;
+  typedef VectorListIterator<T, StatsPolicy> iterator;
+  typedef VectorListSegment<T> segment;
+  typedef Allocator allocator_type;
+
 private:
-  Blocks<T> blocks_;
-  FreeLists<T> free_lists_;
-  Element<T>* first_;
-  Element<T>* last_;
+  // slots freed by a bulk erase on their way to the pool
+  struct FreeChain
+  {
+    SlotId head = NULL_SLOT;
+    size_t count = 0;
+  };
+
+  // the Free slots a block holds itself: a chain of the slots given
+  // back to it, and the slots from fresh on, which were never handed
+  // out and are not linked yet. prev and next link the blocks of a
+  // node that hold any
+  struct BlockFree
+  {
+    SlotId head = NULL_SLOT;
+    size_t count = 0;
+    size_t fresh = 1;
+    size_t prev = NULL_BLOCK;
+    size_t next = NULL_BLOCK;
+  };
+
+  Allocator allocator_;
+  SlotBlocks<T, Allocator> blocks_;
+
+  // emptied blocks kept aside by trim() for growth to reuse,
+  // and the node each of them is for
+  SlotBlocks<T, Allocator> spares_;
+  std::vector<size_t> spare_nodes_;
 
-  size_t size_;
-  size_t capacity_;
+  // blocks dropped from a container in a file, which the state last
+  // synced to the file may still name, freed by the next sync()
+  SlotBlocks<T, Allocator> retired_;
+
+  // lock-free readable view of blocks_, which is indexed by block id
+  BlockTable<T> table_;
+
+  // one cache per thread index, and one shared pool per node
+  // made of the free state of its blocks, indexed by block id
+  FreeCaches caches_;
+  FreePools pools_;
+  std::vector<BlockFree> block_free_;
+  size_t num_nodes_;
+
+  // guards blocks_, table_ growth, pools_ and block_free_
+  std::atomic_flag lock_;
+
+  std::atomic<size_t> capacity_;
+  std::atomic<size_t> empty_blocks_;
   size_t block_size_;
 
-  void pushBlock( void );
+  [[no_unique_address]] StatsPolicy stats_;
+
+  // the file the blocks live in, for a container opened from one
+  Utils::MappedFile* file_;
+
+  void pushBlock( size_t size, size_t node );
+  void pushBlock( SlotBlock<T, Allocator>&& block, size_t node );
+  void grow( size_t node );
+  void linkBoundaries( void );
+  void dropBlocks( const std::vector<size_t>& ids, size_t keep );
+  void refill( FreeCache& cache );
+  void flush( FreeCache& cache );
+  FreeCache* getCache( void );
+  size_t currentNode( void ) const;
+  Slot<T>* getSlot( SlotId slot );
+  void unlinkFree( FreeCache& cache, const std::vector<bool>& dropped );
+  size_t freeIn( size_t id ) const;
+  void listFree( size_t id );
+  void unlistFree( size_t id );
+  void relistFree( void );
+  SlotId popFree( size_t id );
+  SlotId takeSlots( size_t node, size_t n, Slot<T>*& tail );
+  void giveSlot( SlotId slot );
+  void giveSlots( SlotId head );
+  SlotId takeFree( size_t n );
+  void giveFree( SlotId head );
+  void addLive( std::ptrdiff_t delta );
+  void destroyAll( void );
+  std::ptrdiff_t drainCaches( void );
+  void resetBlocks( void );
+  void copyBlock( const BlockInfo<T>& source, size_t fresh );
+  std::atomic_flag& getLock( const iterator& it );
+  const BlockInfo<T>* handleInfo( Handle handle ) const;
+  bool isCurrent( const BlockInfo<T>& info, Handle handle ) const;
+  size_t blockAt( size_t k ) const;
+  void openFrom( const PersistentList& list );
+  void recover( void );
+  void releaseBlocks( void );
+
+  template <class... Args>
+  iterator emplaceAt( SlotId slot, Args&&... args );
+  template <class... Args>
+  iterator emplaceFrom( FreeCache& cache, Args&&... args );
+  SlotId vacate( size_t block, Slot<T>* slot );
+  void removeTo( FreeCache& cache, size_t block, Slot<T>* slot );
+  void removeAt( size_t block, Slot<T>* slot );
+
+  template <class F>
+  void insertSlots( size_t n, F&& fill );
+  template <class Pred>
+  void eraseBits( size_t block, size_t lo, size_t hi, Pred& pred, FreeChain& chain );
+  template <class Pred>
+  size_t eraseRange( const iterator& first, const iterator& last, Pred&& pred );
+  size_t giveErased( FreeChain* chains, size_t n );
+
+  std::vector<Utils::BlockChunk> makeChunks( size_t node ) const;
+  template <class F>
+  void runChunks( const std::vector<Utils::BlockChunk>& chunks, size_t num_threads, F&& work );
+  template <class F>
+  void forEachIn( const Utils::BlockChunk& chunk, F& f );
 
 public:
   VectorList( void );
-//  VectorList(const VectorList& other);
+  explicit VectorList( const Allocator& allocator );
+  ~VectorList( void );
+  VectorList( const VectorList& other );
+  explicit VectorList( Utils::MappedFile& file )
+    requires std::is_trivially_copyable_v<T> && std::is_constructible_v<Allocator, std::pmr::memory_resource*>;
 //  VectorList(VectorList&& other);
 //  VectorList& operator=(const VectorList& other);
 //  VectorList& operator=(VectorList&& other);
   friend void vectorListConstructorTests<int>( void );
+  friend void vectorListEmplaceTests<int>( void );
+  friend void vectorListIteratorTests<int>( void );
+  friend void vectorListLockTests<int>( void );
+  friend void vectorListGrowthTests<int>( void );
+  friend void vectorListTrimTests<int>( void );
+  friend void vectorListBulkTests<int>( void );
+  friend void vectorListParallelTests<int>( void );
+  friend void vectorListHandleTests<int>( void );
+  friend void vectorListStatsTests<int>( void );
+  friend void vectorListNodeTests<int>( void );
+  friend void vectorListPersistenceTests<int>( void );
+  friend void vectorListSnapshotTests<int>( void );
+  friend void vectorListCompactTests<int>( void );
+
+  template <class... Args>
+  iterator emplace( Args&&... args );
+  bool remove( iterator& it );
+
+  template <class... Args>
+  Handle emplaceHandle( Args&&... args );
+  Handle handleOf( const iterator& it ) const;
+  T* get( Handle handle );
+  template <class F>
+  bool update( Handle handle, F&& f );
+  bool remove( Handle handle );
+
+  template <class InputIt>
+    requires std::input_iterator<InputIt>
+  void insert( InputIt first, InputIt last );
+  void insert( size_t n, const T& value );
+  template <class Pred>
+  size_t eraseIf( Pred pred );
+  size_t erase( const iterator& first, const iterator& last );
+
+  template <class F>
+  void parallelForEach( F f, size_t num_threads = 0, size_t node = ALL_NODES );
+  template <class R, class Transform, class Reduce>
+  R parallelReduce( R init, Transform transform, Reduce reduce, size_t num_threads = 0, size_t node = ALL_NODES );
+  template <class Pred>
+  size_t parallelEraseIf( Pred pred, size_t num_threads = 0, size_t node = ALL_NODES );
+
+  void reserve( size_t n );
+  size_t trim( size_t keep = TRIM_RESERVE_BLOCKS );
+  size_t shrinkToFit( void );
+  template <class F>
+  size_t compact( size_t budget, F relocated );
+  size_t compact( size_t budget );
+  void clear( void );
+  void sync( void );
+  void snapshot( int fd )
+    requires std::is_trivially_copyable_v<T>;
+  void restore( int fd )
+    requires std::is_trivially_copyable_v<T>;
+
+  template <class F>
+  auto withLocked( iterator& it, F&& f ) -> Utils::MaybeResult<decltype( f( std::declval<T&>() ) )>;
+  template <class F>
+  bool tryUpdate( iterator& it, F&& f );
 
   size_t size( void ) const;
   size_t capacity( void ) const;
+  size_t emptyBlocks( void ) const;
+  Allocator getAllocator( void ) const;
+  size_t nodes( void ) const;
+  size_t nodeOf( const iterator& it ) const;
+
+  iterator begin( void );
+  iterator end( void );
+  iterator rbegin( void );
+  iterator rend( void );
+
+  Utils::ContainerStats stats( void )
+    requires StatsPolicy::enabled;
+
+  VectorListSegments<T> segments( size_t node = ALL_NODES ) const;
+
+  T* slotAt( size_t k );
+  iterator iteratorAt( size_t k );
+  size_t indexOf( const iterator& it ) const;
 };
 
+namespace pmr
+{
+/*
+ * A VectorList whose blocks come from a std::pmr::memory_resource
+ * */
+template <class T, class LockPolicy = Utils::BackoffPolicy, class GrowthPolicy = Utils::LinearGrowth<>,
+          class StatsPolicy = Utils::NoStats, class NodePolicy = Utils::SingleNode>
+using VectorList = ::VectorList<T, LockPolicy, GrowthPolicy, std::pmr::polymorphic_allocator<T>, StatsPolicy, NodePolicy>;
+}
+
 #include "./constructors.hpp"
 #include "./methods.hpp"
+#include "./persistence.hpp"
+#include "./snapshot.hpp"
 
 #endif // VECTORLIST_HPP_